@@ -0,0 +1,179 @@
+#pragma once
+
+#include "common.h"
+#include "SeqLock.h"
+#include "OrderType.h"
+#include <cmath>
+
+// Account as a pre-trade check sees it.
+struct AccountSnapshot {
+    double cash = 0.0;
+    double buying_power = 0.0;
+    double reserved = 0.0;              // buying power held by accepted, not yet filled buy orders
+    double equity = 0.0;                // cash + net position exposure (filled in by Portfolio)
+    std::uint64_t updates = 0;          // trade updates applied since construction
+    std::uint32_t version = 0;          // even; bumps by 2 per update
+};
+
+// Local minus broker, as found by one reconciliation.
+struct AccountDrift {
+    double cash = 0.0;
+    double buying_power = 0.0;
+    std::uint64_t reconciliations = 0;
+    double max_abs_cash = 0.0;          // over every reconciliation so far
+    double max_abs_buying_power = 0.0;
+};
+
+// Cash and buying power kept current from trade_updates instead of polled from /v2/account:
+// an accepted ("new") buy reserves qty * price of buying power, fills move cash and convert the
+// reservation, and cancel/expire/reject/replace release what is left. reconcile() rebases on the
+// broker's numbers now and then and reports how far the local view had drifted.
+// Readers go through a seqlock (SeqLock.h) and never block. The writers - the trade update
+// thread and the occasional reconciliation - serialize on a SpinGuard, which is uncontended in
+// practice. Reservations are tracked for our own orders only (client_seq != 0), in a fixed ring
+// indexed by client_seq, so nothing allocates.
+class AccountState {
+
+    struct alignas(kCacheLine) Record {
+        std::atomic<std::uint32_t> seq{ 0 };
+        std::atomic<double> cash{ 0.0 };
+        std::atomic<double> buying_power{ 0.0 };
+        std::atomic<double> reserved{ 0.0 };
+        std::atomic<std::uint64_t> updates{ 0 };
+    };
+
+    struct Reservation {
+        std::uint64_t client_seq = 0;
+        double price = 0.0;
+        double remaining_qty = 0.0;
+    };
+
+public:
+
+    static constexpr std::size_t kMaxOpenOrders = 4096;
+
+    explicit AccountState(double iCash) {
+        mRecord.cash.store(iCash, std::memory_order_relaxed);
+        mRecord.buying_power.store(iCash, std::memory_order_relaxed);
+    }
+
+    AccountState(const AccountState&) = delete;
+    AccountState& operator=(const AccountState&) = delete;
+
+    // Order accepted by the broker; buys hold qty * price of buying power until filled or closed.
+    void on_accepted(std::uint64_t client_seq, Action side, double qty, double price) noexcept {
+        if (client_seq == 0 || side != Action::Buy || !(qty > 0.0)) return;
+
+        SpinGuard guard(mWriting);
+        Reservation& slot = mOrders[client_seq & (kMaxOpenOrders - 1)];
+        // A slot still held by an order kMaxOpenOrders older is released; reconcile() corrects it.
+        const double released = (slot.client_seq != 0) ? slot.remaining_qty * slot.price : 0.0;
+        slot = { client_seq, price, qty };
+        const double hold = qty * price;
+
+        publish(0.0, hold - released, released - hold);
+    }
+
+    void on_fill(std::uint64_t client_seq, Action side, double qty, double price) noexcept {
+        if (!(qty > 0.0)) return;
+
+        SpinGuard guard(mWriting);
+        const double notional = qty * price;
+        if (side == Action::Sell) {
+            publish(notional, 0.0, notional);
+            return;
+        }
+
+        double released = 0.0;
+        if (Reservation* r = find(client_seq)) {
+            const double closed = std::min(qty, r->remaining_qty);
+            released = closed * r->price;
+            r->remaining_qty -= closed;
+            if (r->remaining_qty <= 0.0) *r = {};
+        }
+        publish(-notional, -released, released - notional);
+    }
+
+    // Canceled, expired, rejected or done for the day: the unfilled part stops holding buying power.
+    void on_closed(std::uint64_t client_seq) noexcept {
+        SpinGuard guard(mWriting);
+        Reservation* r = find(client_seq);
+        if (!r) return;
+
+        const double released = r->remaining_qty * r->price;
+        *r = {};
+        publish(0.0, -released, released);
+    }
+
+    // Broker truth from /v2/account. Fills in flight while the request was out show up as drift.
+    // The broker's buying power already nets out the holds of its open orders, so reservations of
+    // orders that is_open(client_seq) says are done are dropped instead of being released on top
+    // of it later, and reserved is recomputed from the rest.
+    template <class IsOpen>
+    AccountDrift reconcile(double iCash, double iBuyingPower, IsOpen&& is_open) noexcept {
+        SpinGuard guard(mWriting);
+        double reserved = 0.0;
+        for (Reservation& r : mOrders) {
+            if (r.client_seq == 0) continue;
+            if (!is_open(r.client_seq)) {
+                r = {};
+                continue;
+            }
+            reserved += r.remaining_qty * r.price;
+        }
+
+        mDrift.cash = mRecord.cash.load(std::memory_order_relaxed) - iCash;
+        mDrift.buying_power = mRecord.buying_power.load(std::memory_order_relaxed) - iBuyingPower;
+        mDrift.max_abs_cash = std::max(mDrift.max_abs_cash, std::abs(mDrift.cash));
+        mDrift.max_abs_buying_power = std::max(mDrift.max_abs_buying_power, std::abs(mDrift.buying_power));
+        ++mDrift.reconciliations;
+
+        seqlock_write(mRecord.seq, [&] {
+            mRecord.cash.store(iCash, std::memory_order_relaxed);
+            mRecord.buying_power.store(iBuyingPower, std::memory_order_relaxed);
+            mRecord.reserved.store(reserved, std::memory_order_relaxed);
+            });
+        return mDrift;
+    }
+
+    // Reader side (any thread). equity is left for the caller.
+    std::uint32_t read(AccountSnapshot& out) const noexcept {
+        return seqlock_read(mRecord.seq, out.version, [&] {
+            out.cash = mRecord.cash.load(std::memory_order_relaxed);
+            out.buying_power = mRecord.buying_power.load(std::memory_order_relaxed);
+            out.reserved = mRecord.reserved.load(std::memory_order_relaxed);
+            out.updates = mRecord.updates.load(std::memory_order_relaxed);
+            });
+    }
+
+    // Single field, no retry loop needed.
+    double buying_power() const noexcept { return mRecord.buying_power.load(std::memory_order_acquire); }
+    double cash() const noexcept { return mRecord.cash.load(std::memory_order_acquire); }
+
+private:
+
+    Reservation* find(std::uint64_t client_seq) noexcept {
+        if (client_seq == 0) return nullptr;
+        Reservation& slot = mOrders[client_seq & (kMaxOpenOrders - 1)];
+        return slot.client_seq == client_seq ? &slot : nullptr;
+    }
+
+    // Under the write guard.
+    void publish(double cash_delta, double reserved_delta, double buying_power_delta) noexcept {
+        const double cash = mRecord.cash.load(std::memory_order_relaxed) + cash_delta;
+        const double reserved = mRecord.reserved.load(std::memory_order_relaxed) + reserved_delta;
+        const double buying_power = mRecord.buying_power.load(std::memory_order_relaxed) + buying_power_delta;
+        const std::uint64_t updates = mRecord.updates.load(std::memory_order_relaxed) + 1;
+        seqlock_write(mRecord.seq, [&] {
+            mRecord.cash.store(cash, std::memory_order_relaxed);
+            mRecord.reserved.store(reserved, std::memory_order_relaxed);
+            mRecord.buying_power.store(buying_power, std::memory_order_relaxed);
+            mRecord.updates.store(updates, std::memory_order_relaxed);
+            });
+    }
+
+    Record mRecord;
+    std::atomic_flag mWriting = ATOMIC_FLAG_INIT;
+    AccountDrift mDrift;
+    std::array<Reservation, kMaxOpenOrders> mOrders{};
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "common.h"
+#include "myboost.h"
+#include "FastQueue.hpp"
+#include "MarketDataDecoder.h"
+#include "QuoteCache.h"
+#include "TradingState.h"
+#include <memory>
+#include <queue>
+#include <span>
+
+// Simulated time for backtests: nanoseconds, moved forward by the engine to each event it
+// processes. Everything a backtest stamps (OrderMsg::ts_qpc, TradeUpdateMsg::ts_recv, risk
+// token buckets) uses it instead of qpc_now().
+class SimClock {
+
+public:
+
+    static constexpr std::uint64_t kFrequency = 1'000'000'000;
+
+    std::uint64_t now() const noexcept { return mNow; }
+    void advance_to(std::uint64_t t) noexcept { if (t > mNow) mNow = t; }
+
+private:
+
+    std::uint64_t mNow = 0;
+};
+
+// One historical market data event; a backtest's input is a span of these sorted by ts.
+struct MarketEvent {
+    std::uint64_t ts = 0;               // SimClock ns
+    double bid = 0.0;                   // Quote
+    double ask = 0.0;
+    double price = 0.0;                 // Trade price / Bar close
+    std::uint32_t size = 0;             // Trade size / Bar volume
+    SymbolId symbol = kNoSymbol;
+    MarketDataType type = MarketDataType::Quote;
+};
+
+// How the fill simulator answers an order in place of alpaca_post_order + trade_updates:
+// "new" after the ack latency, then one fill at the opposite side of the book at that time,
+// moved against us by slippage. Orders for symbols with no price yet are rejected.
+struct FillModel {
+    std::uint64_t ack_ns = 1'000'000;
+    std::uint64_t jitter_ns = 500'000;  // uniform [0, jitter) added to the ack latency
+    std::uint64_t fill_ns = 500'000;    // ack -> fill
+    double slippage_bps = 1.0;
+    std::uint64_t seed = 1;             // jitter stream; same seed, same run
+};
+
+struct BacktestConfig {
+    double cash = 100'000.0;
+    RiskLimits limits{};
+    FillModel fills{};
+    std::uint32_t equity_sample = 256;  // market events between drawdown samples (fills always sample)
+};
+
+struct BacktestResult {
+    double cash = 0.0;
+    double equity = 0.0;
+    double realized = 0.0;
+    double unrealized = 0.0;
+    double max_drawdown = 0.0;          // largest peak-to-trough fall of sampled equity
+    std::uint64_t events = 0;           // market events
+    std::uint64_t orders = 0;           // submitted by the strategy
+    std::uint64_t risk_rejects = 0;
+    std::uint64_t fills = 0;
+    std::uint64_t rejected = 0;         // by the simulator (no price)
+    double sim_seconds = 0.0;
+    double wall_seconds = 0.0;
+
+    bool operator==(const BacktestResult& o) const noexcept {
+        return cash == o.cash && equity == o.equity && realized == o.realized && unrealized == o.unrealized
+            && max_drawdown == o.max_drawdown && events == o.events && orders == o.orders
+            && risk_rejects == o.risk_rejects && fills == o.fills && rejected == o.rejected;
+    }
+};
+
+// Event-driven, single-threaded backtest over historical MarketEvents with the live types:
+// market data lands in a QuoteCache, the strategy's OrderMsgs go through a FastQueue to the
+// fill simulator (which runs TradingState::risk_check and the OMS like alpaca_post_order), and
+// simulated trade updates drive the same TradingState the live Portfolio uses.
+// Time is a SimClock, so a run does not sleep and its result depends only on the events, the
+// strategy and the config.
+//
+// A Strategy provides:
+//   void on_market(const MarketEvent& e, BacktestEngine& bt);
+//   void on_trade_update(const TradeUpdateMsg& u, BacktestEngine& bt);
+// and trades through submit(). Orders are sent after the callback returns, in submit order.
+class BacktestEngine {
+
+public:
+
+    explicit BacktestEngine(const BacktestConfig& iConfig);
+
+    BacktestEngine(const BacktestEngine&) = delete;
+    BacktestEngine& operator=(const BacktestEngine&) = delete;
+
+    template <class Strategy>
+    BacktestResult run(std::span<const MarketEvent> iEvents, Strategy& iStrategy) {
+        const auto t0 = std::chrono::steady_clock::now();
+
+        std::size_t next = 0;
+        while (next < iEvents.size() || !mPending.empty()) {
+            // Trade updates due no later than the next market event go first.
+            if (!mPending.empty() && (next == iEvents.size() || mPending.top().due <= iEvents[next].ts)) {
+                const TradeUpdateMsg u = deliver_next();
+                iStrategy.on_trade_update(u, *this);
+            }
+            else {
+                const MarketEvent& e = iEvents[next++];
+                on_market(e);
+                iStrategy.on_market(e, *this);
+            }
+            send_orders();
+        }
+
+        return finish(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+
+    // Strategy side.
+    std::uint64_t now() const noexcept { return mClock.now(); }
+    bool quote(SymbolId iSymbol, Quote& oQuote) const noexcept;
+    bool position(SymbolId iSymbol, Position& oPosition) const noexcept { return mState.position(iSymbol, oPosition); }
+    double buying_power() const noexcept { return mState.buying_power(); }
+
+    // Queues a market order; returns its client seq (what trade updates carry as client_seq).
+    std::uint64_t submit(SymbolId iSymbol, Action iSide, std::uint32_t iQty);
+
+    TradingState& state() noexcept { return mState; }
+
+private:
+
+    using OrderQueue = FastQueue<(1u << 16), 8, (1u << 12)>;
+
+    struct Pending {
+        std::uint64_t due = 0;
+        std::uint64_t order = 0;        // insertion order breaks ties deterministically
+        TradeUpdateMsg update{};
+
+        bool operator>(const Pending& o) const noexcept { return due != o.due ? due > o.due : order > o.order; }
+    };
+
+    void on_market(const MarketEvent& e) noexcept;
+    void send_orders();
+    void simulate_post(const OrderMsg& m);
+    void schedule(std::uint64_t due, const TradeUpdateMsg& u);
+    TradeUpdateMsg deliver_next() noexcept;
+    void sample_equity() noexcept;
+    BacktestResult finish(double iWallSeconds) noexcept;
+    std::uint64_t next_random() noexcept;
+
+    BacktestConfig mConfig;
+    SimClock mClock;
+    QuoteCache<> mQuotes;
+    TradingState mState;
+
+    OrderQueue mOrderQueue;
+    FastQueueProducer<(1u << 16), 8, (1u << 12)> mOrderOut;
+    FastQueueConsumer<(1u << 16), 8, (1u << 12)> mOrderIn;
+
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> mPending;
+    std::uint64_t mPendingOrder = 0;
+    std::uint64_t mRandom;
+
+    std::uint64_t mFirstTs = 0;
+    double mPeakEquity = 0.0;
+    BacktestResult mResult;
+};
+
+// Runs one backtest per parameter set over the same events, spread over up to iThreads cores.
+// iMakeStrategy(params) builds a fresh strategy for each run. results[i] answers params[i] and
+// is the same whatever the thread count: runs share nothing but the read-only events (and
+// SymbolTable, whose ids must be interned before the call).
+template <class Params, class MakeStrategy>
+std::vector<BacktestResult> run_backtests(std::span<const MarketEvent> iEvents, std::span<const Params> iParams,
+    MakeStrategy iMakeStrategy, const BacktestConfig& iConfig, unsigned iThreads)
+{
+    std::vector<BacktestResult> results(iParams.size());
+    std::atomic<std::size_t> next{ 0 };
+
+    auto worker = [&] {
+        for (std::size_t i = next.fetch_add(1); i < iParams.size(); i = next.fetch_add(1)) {
+            auto engine = std::make_unique<BacktestEngine>(iConfig);
+            auto strategy = iMakeStrategy(iParams[i]);
+            results[i] = engine->run(iEvents, strategy);
+        }
+    };
+
+    const unsigned n = std::max(1u, std::min<unsigned>(iThreads, static_cast<unsigned>(iParams.size())));
+    std::vector<boost::thread> threads;
+    for (unsigned t = 1; t < n; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+
+    return results;
+}
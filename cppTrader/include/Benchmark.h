@@ -1,29 +1,41 @@
 #pragma once
 
 #include "common.h"
-#include "log2histogram.hpp"
+#include "HdrHistogram.hpp"
 #include "myboost.h"
+#include "WaitStrategy.h"
+#include "Clock.h"
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Hot-path timestamps in TscClock ticks (TSC on Linux, QPC on Windows; see Clock.h).
 static inline std::uint64_t qpc_now() 
 {
-    LARGE_INTEGER t;
-    QueryPerformanceCounter(&t);
-    return static_cast<std::uint64_t>(t.QuadPart);
+    return TscClock::now();
 }
 static inline std::uint64_t qpc_freq() 
 {
-    LARGE_INTEGER f;
-    QueryPerformanceFrequency(&f);
-    return static_cast<std::uint64_t>(f.QuadPart);
+    return TscClock::frequency();
 }
 static void pin_current_thread_to_cpu(unsigned cpu_index) 
 {
+#if defined(_WIN32)
     DWORD_PTR mask = (DWORD_PTR(1) << cpu_index);
     SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu_index, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
 }
 
 static inline std::uint64_t ticks_to_ns(std::uint64_t ticks, std::uint64_t freq) {
-    // ns = ticks * 1e9 / freq
+    // Clock ticks: fixed-point multiply/shift. Anything else: ns = ticks * 1e9 / freq
+    if (freq == TscClock::frequency()) return TscClock::to_ns(ticks);
     long double ns = (long double)ticks * 1000000000.0L / (long double)freq;
     return (std::uint64_t)ns;
 }
@@ -31,7 +43,9 @@ static inline std::uint64_t ticks_to_ns(std::uint64_t ticks, std::uint64_t freq)
 struct BenchConfig {
     std::uint64_t messages = 5'000'000;
     std::uint32_t sample_every = 1;             // record latency every N messages (1 = all)
-    std::chrono::microseconds empty_backoff{ 50 }; // async sleep when queue empty
+    std::chrono::microseconds empty_backoff{ 50 }; // async sleep when queue empty (WaitMode::AsioTimer)
+    WaitMode wait = WaitMode::AsioTimer;           // consumer behaviour on an empty queue
+    std::uint32_t spin_limit = 10'000;             // empty polls before yielding/blocking
 };
 
 struct BenchResults {
@@ -42,7 +56,7 @@ struct BenchResults {
     std::uint64_t max_ns = 0;
     double avg_ns = 0.0;
 
-    Log2Histogram hist;
+    HdrHistogram hist;
 };
 
 struct TimingState 
@@ -50,3 +64,23 @@ struct TimingState
     std::chrono::steady_clock::time_point start{};
     std::chrono::steady_clock::time_point end{};
 };
+
+// Benchmark entry points selected from main() by name.
+int run_serializer_benchmark(std::uint64_t iterations);
+int run_decoder_benchmark(std::uint64_t iterations);
+int run_mpsc_benchmark(std::uint64_t per_producer, unsigned max_producers);
+int run_broadcast_benchmark(std::uint64_t messages, unsigned max_consumers);
+int run_shm_benchmark(std::string_view role, const std::string& name, std::uint64_t messages);
+int run_journal_benchmark(const std::string& dir, std::uint64_t messages);
+int run_journal_replay(const std::string& dir, const std::string& name, bool paced);
+int run_hdr_report(const std::vector<std::string>& files);
+int run_sweep_benchmark(const std::string& out_prefix, const std::string& baseline, std::uint64_t messages);
+int run_quote_cache_benchmark(std::uint64_t messages, unsigned readers);
+int run_risk_benchmark(std::uint64_t iterations);
+int run_oms_benchmark(std::uint64_t orders);
+int run_rest_scheduler_benchmark();
+int run_backtest_benchmark(std::uint64_t events, unsigned threads);
+
+// Histogram files for offline comparison (HdrHistogram::encode on disk).
+bool save_histogram(const HdrHistogram& h, const std::string& path);
+HdrHistogram load_histogram(const std::string& path);
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "common.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define CPPTRADER_HAS_RDTSC 1
+#endif
+#endif
+
+#ifndef CPPTRADER_HAS_RDTSC
+#define CPPTRADER_HAS_RDTSC 0
+#endif
+
+// Hot-path timestamp source.
+//   Linux/x86 with an invariant TSC : rdtsc, calibrated against CLOCK_MONOTONIC_RAW at startup
+//   other POSIX                     : clock_gettime(CLOCK_MONOTONIC_RAW), ticks are ns
+//   Windows                         : QueryPerformanceCounter (itself TSC-backed on modern CPUs)
+// Tick deltas convert to ns with a precomputed fixed-point multiply/shift, no division.
+struct ClockCalibration {
+    enum class Source : std::uint8_t { Tsc, MonotonicRaw, Qpc };
+
+    Source source = Source::MonotonicRaw;
+    std::uint64_t ticks_per_sec = 1'000'000'000;
+    std::uint64_t mult = std::uint64_t(1) << 32;     // ns = (ticks * mult) >> shift
+    unsigned shift = 32;
+};
+
+class TscClock {
+
+public:
+
+    // Plain read: cheapest, but the CPU may execute it early or late relative to neighbours.
+    static std::uint64_t now() noexcept {
+#if defined(_WIN32)
+        LARGE_INTEGER t;
+        QueryPerformanceCounter(&t);
+        return static_cast<std::uint64_t>(t.QuadPart);
+#else
+#if CPPTRADER_HAS_RDTSC
+        if (calibration().source == ClockCalibration::Source::Tsc) return __rdtsc();
+#endif
+        return raw_ns();
+#endif
+    }
+
+    // Not executed before earlier instructions complete (lfence; rdtsc). Use at the start of a
+    // measured region.
+    static std::uint64_t now_ordered() noexcept {
+#if CPPTRADER_HAS_RDTSC
+        if (calibration().source == ClockCalibration::Source::Tsc) {
+            _mm_lfence();
+            return __rdtsc();
+        }
+#endif
+        return now();
+    }
+
+    // Waits for earlier instructions and keeps later ones from starting first (rdtscp; lfence).
+    // Use at the end of a measured region.
+    static std::uint64_t now_serialized() noexcept {
+#if CPPTRADER_HAS_RDTSC
+        if (calibration().source == ClockCalibration::Source::Tsc) {
+            unsigned aux;
+            const std::uint64_t t = __rdtscp(&aux);
+            _mm_lfence();
+            return t;
+        }
+#endif
+        return now();
+    }
+
+    static std::uint64_t frequency() noexcept { return calibration().ticks_per_sec; }
+
+    static std::uint64_t to_ns(std::uint64_t ticks) noexcept {
+        const ClockCalibration& c = calibration();
+        return mul_shift(ticks, c.mult, c.shift);
+    }
+
+    static const char* source_name() noexcept {
+        switch (calibration().source) {
+        case ClockCalibration::Source::Tsc: return "tsc";
+        case ClockCalibration::Source::Qpc: return "qpc";
+        default: return "clock_monotonic_raw";
+        }
+    }
+
+    // Calibrated once, on first use; call it from main() to keep the ~20 ms calibration off the
+    // hot path.
+    static const ClockCalibration& calibration() noexcept {
+        static const ClockCalibration c = calibrate();
+        return c;
+    }
+
+private:
+
+    static std::uint64_t mul_shift(std::uint64_t ticks, std::uint64_t mult, unsigned shift) noexcept {
+#if defined(_MSC_VER) && defined(_M_X64)
+        std::uint64_t hi;
+        const std::uint64_t lo = _umul128(ticks, mult, &hi);
+        return __shiftright128(lo, hi, static_cast<unsigned char>(shift));
+#elif defined(__SIZEOF_INT128__)
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(ticks) * mult) >> shift);
+#else
+        return static_cast<std::uint64_t>(static_cast<long double>(ticks) * mult / (long double)(std::uint64_t(1) << shift));
+#endif
+    }
+
+    static void set_rate(ClockCalibration& c, std::uint64_t ticks_per_sec) noexcept {
+        c.ticks_per_sec = ticks_per_sec;
+        c.shift = 32;
+        c.mult = static_cast<std::uint64_t>((1'000'000'000.0L * (long double)(std::uint64_t(1) << c.shift)) / (long double)ticks_per_sec);
+    }
+
+#if !defined(_WIN32)
+    static std::uint64_t raw_ns() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+    }
+#endif
+
+#if CPPTRADER_HAS_RDTSC
+    // CPUID 0x80000007 EDX bit 8: the TSC ticks at a constant rate across P/C-states and cores.
+    static bool has_invariant_tsc() noexcept {
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+        __get_cpuid(0x80000007, &a, &b, &c, &d);
+        return (d & (1u << 8)) != 0;
+    }
+#endif
+
+    static ClockCalibration calibrate() noexcept {
+        ClockCalibration c;
+#if defined(_WIN32)
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        c.source = ClockCalibration::Source::Qpc;
+        set_rate(c, static_cast<std::uint64_t>(f.QuadPart));
+#elif CPPTRADER_HAS_RDTSC
+        if (has_invariant_tsc()) {
+            // Bracket each end with raw clock reads and spin ~20 ms in between; the error is a
+            // few hundred ns over 20 ms, i.e. ~10 ppm.
+            const std::uint64_t ns0 = raw_ns();
+            const std::uint64_t tsc0 = __rdtsc();
+            std::uint64_t ns1 = ns0;
+            while (ns1 - ns0 < 20'000'000) ns1 = raw_ns();
+            const std::uint64_t tsc1 = __rdtsc();
+            const std::uint64_t ns2 = raw_ns();
+
+            const long double elapsed_ns = (long double)(ns1 + ns2) / 2.0L - (long double)ns0;
+            c.source = ClockCalibration::Source::Tsc;
+            set_rate(c, static_cast<std::uint64_t>((long double)(tsc1 - tsc0) * 1e9L / elapsed_ns));
+        }
+        else {
+            set_rate(c, 1'000'000'000);
+        }
+#else
+        set_rate(c, 1'000'000'000);
+#endif
+        return c;
+    }
+};
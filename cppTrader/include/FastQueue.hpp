@@ -7,11 +7,22 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
+#include <new>
 #include <span>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 
+#include "SharedMemory.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 constexpr std::size_t kCacheLine = 64;
 
@@ -34,6 +45,24 @@ struct alignas(kCacheLine) PaddedAtomicU64 {
 };
 static_assert(sizeof(PaddedAtomicU64) == kCacheLine);
 
+// Spin-wait hint: frees pipeline resources for the sibling hyperthread.
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// What FastQueueProducer::write does when the consumer has not freed enough room.
+// try_write never waits and never overwrites, whatever the policy.
+enum class OverflowPolicy : std::uint8_t {
+    SpinWait,       // wait for the consumer (order flow: nothing may be lost)
+    DropOldest,     // overwrite unread frames; the consumer detects it and resyncs (market data)
+};
+
 struct FastQueueStorage {
     //must deallocate with the matching aligned
     std::unique_ptr<std::byte, void(*)(void*)> buf{ nullptr, +[](void* p) {
@@ -44,8 +73,32 @@ struct FastQueueStorage {
     } };
     std::size_t capacity = 0;
     std::size_t mask = 0;
+    SharedMemoryRegion shm;     // set instead of buf when the queue lives in a shared mapping
  };
 
+// Control block at the start of a FastQueue's memory. It takes a whole header page so the ring
+// starts page-aligned, and it lives in the mapping when the queue is shared between processes.
+// The layout fields let an attaching process check that it was built with the same parameters.
+inline constexpr std::uint64_t kFastQueueMagic = 0x3150'5145'5453'4146ull;   // "FASTQEP1"
+inline constexpr std::uint32_t kFastQueueLayoutVersion = 1;
+inline constexpr std::size_t kFastQueueHeaderBytes = 4096;
+inline constexpr std::int32_t kFastQueueWrapMarker = -1;
+
+struct alignas(kCacheLine) FastQueueControl {
+    std::atomic<std::uint64_t> magic{ 0 };   // stored last by the creator
+    std::uint32_t version = 0;
+    std::uint32_t header_bytes = 0;
+    std::uint64_t capacity = 0;
+    std::uint64_t block_alignment = 0;
+    std::uint64_t reserve_block = 0;
+
+    PaddedAtomicU64 write_reserve_{};
+    PaddedAtomicU64 write_commit_{};
+    PaddedAtomicU64 read_commit_{};     // consumer position; the producer only reads it when its cached copy runs out
+};
+static_assert(sizeof(FastQueueControl) <= kFastQueueHeaderBytes);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "cross-process queues need address-free atomics");
+
 template <std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
 class FastQueue;
 
@@ -61,12 +114,15 @@ class FastQueue {
     static_assert(is_pow2(CapacityBytes), "CapacityBytes must be power-of-two");
     static_assert(is_pow2(BlockAlignment), "BlockAlignment must be power-of-two");
     static_assert(is_pow2(ReservePublishBlockBytes), "ReservePublishBlockBytes must be power-of-two");
+    static_assert(ReservePublishBlockBytes <= CapacityBytes / 2, "ReservePublishBlockBytes must leave room in the ring");
 
 public:
-    static constexpr std::int32_t kWrapMarker = -1;
+    static constexpr std::int32_t kWrapMarker = kFastQueueWrapMarker;
+    static constexpr std::size_t kMappingBytes = kFastQueueHeaderBytes + CapacityBytes;
 
     FastQueue()
         : storage_(allocate_storage()) {
+        init_control(storage_.buf.get());
     }
 
     FastQueue(const FastQueue&) = delete;
@@ -75,8 +131,40 @@ public:
     FastQueue(FastQueue&&) noexcept = default;
     FastQueue& operator=(FastQueue&&) noexcept = default;
 
-    FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes> make_producer() noexcept {
-        return FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>(*this);
+    // Creates a queue in a named shared-memory object (POSIX shm / Windows section); an empty
+    // name gives an anonymous memfd on Linux. The name is removed when this queue is destroyed.
+    static FastQueue create_shared(const std::string& name) {
+        FastQueueStorage s;
+        s.capacity = CapacityBytes;
+        s.mask = CapacityBytes - 1;
+        s.shm = SharedMemoryRegion::create(name, kMappingBytes);
+
+        FastQueue q(std::move(s));
+        q.init_control(q.storage_.shm.data());
+        return q;
+    }
+
+    // Maps a queue created by another process. Throws if it is not initialised yet or was built
+    // with different template parameters.
+    static FastQueue attach_shared(const std::string& name) {
+        FastQueueStorage s;
+        s.capacity = CapacityBytes;
+        s.mask = CapacityBytes - 1;
+        s.shm = SharedMemoryRegion::open(name);
+
+        if (s.shm.size() < kMappingBytes) {
+            throw std::runtime_error("FastQueue " + name + ": mapping is smaller than the queue");
+        }
+
+        FastQueue q(std::move(s));
+        q.attach_control(q.storage_.shm.data(), name);
+        return q;
+    }
+
+    // Handles keep raw pointers into the queue memory, so they stay valid if the FastQueue
+    // object itself is moved, and work the same way on a shared mapping.
+    FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes> make_producer(OverflowPolicy policy = OverflowPolicy::SpinWait) noexcept {
+        return FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>(*this, policy);
     }
 
     FastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes> make_consumer() noexcept {
@@ -87,17 +175,21 @@ private:
     friend class FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
     friend class FastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
 
-    PaddedAtomicU64 write_reserve_{};
-    PaddedAtomicU64 write_commit_{};
     FastQueueStorage storage_;
+    FastQueueControl* ctrl_ = nullptr;
+    std::byte* buf_ = nullptr;
+
+    explicit FastQueue(FastQueueStorage&& s) noexcept
+        : storage_(std::move(s)) {
+    }
 
     static FastQueueStorage allocate_storage() {
         FastQueueStorage s;
         s.capacity = CapacityBytes;
         s.mask = CapacityBytes - 1;
 
-        void* p = ::operator new(CapacityBytes, std::align_val_t(kCacheLine));
-        std::memset(p, 0, CapacityBytes);
+        void* p = ::operator new(kMappingBytes, std::align_val_t(kCacheLine));
+        std::memset(p, 0, kMappingBytes);
 
         s.buf = { reinterpret_cast<std::byte*>(p), +[](void* q) {
             ::operator delete(q, std::align_val_t(kCacheLine));
@@ -105,72 +197,155 @@ private:
         return s;
     }
 
-    std::byte* ptr_at(std::uint64_t counter) noexcept {
-        return storage_.buf.get() + (static_cast<std::size_t>(counter) & storage_.mask);
+    void init_control(std::byte* base) noexcept {
+        ctrl_ = new (base) FastQueueControl{};
+        buf_ = base + kFastQueueHeaderBytes;
+
+        ctrl_->version = kFastQueueLayoutVersion;
+        ctrl_->header_bytes = static_cast<std::uint32_t>(kFastQueueHeaderBytes);
+        ctrl_->capacity = CapacityBytes;
+        ctrl_->block_alignment = BlockAlignment;
+        ctrl_->reserve_block = ReservePublishBlockBytes;
+        ctrl_->magic.store(kFastQueueMagic, std::memory_order_release);
     }
-};
 
+    void attach_control(std::byte* base, const std::string& name) {
+        auto* c = reinterpret_cast<FastQueueControl*>(base);
 
-template < std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
-class FastQueueProducer {
-public:
-    explicit FastQueueProducer(FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>& q) noexcept
-        : q_(&q) {
+        if (c->magic.load(std::memory_order_acquire) != kFastQueueMagic) {
+            throw std::runtime_error("FastQueue " + name + ": not initialised (bad magic)");
+        }
+        if (c->version != kFastQueueLayoutVersion || c->header_bytes != kFastQueueHeaderBytes) {
+            throw std::runtime_error("FastQueue " + name + ": layout version mismatch");
+        }
+        if (c->capacity != CapacityBytes || c->block_alignment != BlockAlignment || c->reserve_block != ReservePublishBlockBytes) {
+            throw std::runtime_error("FastQueue " + name + ": template parameters do not match the creator's");
+        }
+
+        ctrl_ = c;
+        buf_ = base + kFastQueueHeaderBytes;
     }
+};
+
+
+
 
+// Framing shared by FastQueue and BroadcastFastQueue: [int32 size][payload padded to
+// BlockAlignment], with kFastQueueWrapMarker in place of the size where the tail of the ring is
+// too short for the next frame. The producer publishes write_reserve_ a block ahead of
+// write_commit_, so a reader can tell after a copy whether the producer may have overwritten it.
+
+// Producer side of the framing. Derived supplies where the readers are:
+//   std::uint64_t reader_position();    // slowest read position still to be preserved
+template <class Derived, std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
+class FramedRingProducer {
+public:
+    // Applies the producer's OverflowPolicy when the ring is full.
     void write(std::span<const std::byte> payload) {
         write_impl(payload.size(), [&](std::span<std::byte> dst) {
             std::memcpy(dst.data(), payload.data(), payload.size());
-            });
+            }, policy_);
     }
 
     template <class F>
     void write_with(std::size_t payload_size, F&& fill) {
-        write_impl(payload_size, std::forward<F>(fill));
+        write_impl(payload_size, std::forward<F>(fill), policy_);
+    }
+
+    // Fail fast: returns false and writes nothing if the readers have not freed enough room.
+    bool try_write(std::span<const std::byte> payload) {
+        return write_impl(payload.size(), [&](std::span<std::byte> dst) {
+            std::memcpy(dst.data(), payload.data(), payload.size());
+            }, Mode::Fail);
+    }
+
+    template <class F>
+    bool try_write_with(std::size_t payload_size, F&& fill) {
+        return write_impl(payload_size, std::forward<F>(fill), Mode::Fail);
     }
 
     std::uint64_t committed_bytes() const noexcept { return local_counter_; }
+    OverflowPolicy policy() const noexcept { return policy_; }
+
+protected:
+    // start / reserve_published / reader: positions to continue from (0 on a fresh ring).
+    FramedRingProducer(std::byte* buf, std::atomic<std::uint64_t>& write_reserve, std::atomic<std::uint64_t>& write_commit,
+        OverflowPolicy policy, std::uint64_t start, std::uint64_t reserve_published, std::uint64_t reader) noexcept
+        : buf_(buf), write_reserve_(&write_reserve), write_commit_(&write_commit), policy_(policy),
+          local_counter_(start), cached_reserve_publish_(reserve_published), cached_read_(reader) {
+    }
+
+    std::byte* buf_;
+    std::atomic<std::uint64_t>* write_reserve_;
+    std::atomic<std::uint64_t>* write_commit_;
+    OverflowPolicy policy_;
+    std::uint64_t local_counter_;
+    std::uint64_t cached_reserve_publish_;
+    std::uint64_t cached_read_;                 // reloaded only when it no longer leaves room
 
 private:
-    using Q = FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
-    Q* q_;
-    std::uint64_t local_counter_{ 0 };
-    std::uint64_t cached_reserve_publish_{ 0 };
+    enum class Mode : std::uint8_t { Fail };
+
+    std::byte* ptr_at(std::uint64_t counter) const noexcept {
+        return buf_ + (static_cast<std::size_t>(counter) & (CapacityBytes - 1));
+    }
+
+    // Can the producer publish a reserve covering [.., end) without passing the readers?
+    // The check uses the block-aligned reserve because that is what readers validate against.
+    bool fits(std::uint64_t end) const noexcept {
+        return align_up<ReservePublishBlockBytes>(static_cast<std::size_t>(end)) - cached_read_ <= CapacityBytes;
+    }
+
+    template <class M>
+    bool wait_for_room(std::uint64_t end, M mode) {
+        if (fits(end)) return true;                              // fast path: no shared cache line touched
+
+        for (;;) {
+            cached_read_ = static_cast<Derived*>(this)->reader_position();
+            if (fits(end)) return true;
+
+            if constexpr (std::is_same_v<M, Mode>) {
+                return false;
+            }
+            else {
+                if (mode == OverflowPolicy::DropOldest) return true;
+                cpu_relax();
+            }
+        }
+    }
 
     void publish_reserve_if_needed(std::uint64_t new_counter) {
         if (cached_reserve_publish_ < new_counter) {
             cached_reserve_publish_ =
                 align_up<ReservePublishBlockBytes>(static_cast<std::size_t>(new_counter));
-            q_->write_reserve_.v.store(cached_reserve_publish_, std::memory_order_release);
+            write_reserve_->store(cached_reserve_publish_, std::memory_order_release);
         }
     }
 
-    template <class F>
-    void write_impl(std::size_t payload_size, F&& fill) {
+    template <class F, class M>
+    bool write_impl(std::size_t payload_size, F&& fill, M mode) {
         const std::size_t padded_payload = align_up<BlockAlignment>(payload_size);
         const std::size_t frame_bytes = sizeof(std::int32_t) + padded_payload;
-
-        std::size_t pos = static_cast<std::size_t>(local_counter_) & q_->storage_.mask;
-
-        if (pos + sizeof(std::int32_t) > CapacityBytes) {
-            local_counter_ += (CapacityBytes - pos);
-            pos = 0;
-        }
-        else if (pos + frame_bytes > CapacityBytes) {
-            std::byte* p = q_->ptr_at(local_counter_);
-            const std::int32_t marker = Q::kWrapMarker;
-            std::memcpy(p, &marker, sizeof(marker));
-
-            local_counter_ += (CapacityBytes - pos);
+        assert(frame_bytes + ReservePublishBlockBytes <= CapacityBytes && "frame larger than the queue");
+
+        const std::size_t pos = static_cast<std::size_t>(local_counter_) & (CapacityBytes - 1);
+        const std::size_t skip = (pos + frame_bytes > CapacityBytes) ? (CapacityBytes - pos) : 0;
+        if (!wait_for_room(local_counter_ + skip + frame_bytes, mode)) return false;
+
+        // Tail too short for this frame: mark it (when the marker fits) and start at offset 0.
+        if (skip) {
+            if (skip >= sizeof(std::int32_t)) {
+                const std::int32_t marker = kFastQueueWrapMarker;
+                std::memcpy(ptr_at(local_counter_), &marker, sizeof(marker));
+            }
+            local_counter_ += skip;
             publish_reserve_if_needed(local_counter_);
-            q_->write_commit_.v.store(local_counter_, std::memory_order_release);
-
-            pos = 0;
+            write_commit_->store(local_counter_, std::memory_order_release);
         }
 
         publish_reserve_if_needed(local_counter_ + frame_bytes);
 
-        std::byte* base = q_->ptr_at(local_counter_);
+        std::byte* base = ptr_at(local_counter_);
         const std::int32_t sz = static_cast<std::int32_t>(payload_size);
         std::memcpy(base, &sz, sizeof(sz));
 
@@ -182,76 +357,230 @@ private:
         }
 
         local_counter_ += frame_bytes;
-        q_->write_commit_.v.store(local_counter_, std::memory_order_release);
+        write_commit_->store(local_counter_, std::memory_order_release);
+        return true;
     }
 };
 
 
-template < std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
-class FastQueueConsumer {
+// Reader side of the framing. Derived supplies where its position is published:
+//   void publish_read(std::uint64_t counter);    // frees everything before counter
+template <class Derived, std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
+class FramedRingConsumer {
 public:
-    explicit FastQueueConsumer(FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>& q) noexcept
-        : q_(&q) {
-    }
-
     // Returns:
     //  >0 : bytes copied into dst
     //   0 : empty
     //  <0 : dst too small; required size is -return_value
+    // With a DropOldest producer the copy is validated after the fact: a frame the producer
+    // overwrote while it was being read is discarded and the consumer resyncs (see overruns()).
     std::int32_t try_read(std::span<std::byte> dst) {
-        using Q = FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
+        if (lapped(local_counter_)) resync();
 
-        const auto reserve = q_->write_reserve_.v.load(std::memory_order_acquire);
-        assert(reserve - local_counter_ <= CapacityBytes && "queue overflow (consumer too slow)");
+        for (;;) {
+            if (local_counter_ == cached_commit_) {
+                cached_commit_ = write_commit_->load(std::memory_order_acquire);
+            }
+            if (local_counter_ == cached_commit_) return 0;
 
-        if (local_counter_ == cached_commit_) {
-            cached_commit_ = q_->write_commit_.v.load(std::memory_order_acquire);
-        }
-        if (local_counter_ == cached_commit_) return 0;
+            const std::size_t pos = static_cast<std::size_t>(local_counter_) & (CapacityBytes - 1);
 
-        std::size_t pos = static_cast<std::size_t>(local_counter_) & q_->storage_.mask;
+            if (pos + sizeof(std::int32_t) > CapacityBytes) {
+                local_counter_ += (CapacityBytes - pos);
+                continue;
+            }
 
-        if (pos + sizeof(std::int32_t) > CapacityBytes) {
-            local_counter_ += (CapacityBytes - pos);
-            return try_read(dst);
-        }
+            const std::byte* base = ptr_at(local_counter_);
+
+            std::int32_t sz = 0;
+            std::memcpy(&sz, base, sizeof(sz));
+
+            if (sz == kFastQueueWrapMarker) {
+                local_counter_ += (CapacityBytes - pos);
+                continue;
+            }
+
+            const std::size_t payload_size = static_cast<std::size_t>(sz);
+            if (sz < 0 || payload_size > CapacityBytes) {
+                // Only a producer lapping us mid-read can produce garbage sizes.
+                resync();
+                return 0;
+            }
 
-        std::byte* base = q_->ptr_at(local_counter_);
+            if (payload_size > dst.size()) {
+                return -static_cast<std::int32_t>(payload_size);
+            }
 
-        std::int32_t sz = 0;
-        std::memcpy(&sz, base, sizeof(sz));
+            const std::size_t padded_payload = align_up<BlockAlignment>(payload_size);
+            const std::size_t frame_bytes = sizeof(std::int32_t) + padded_payload;
 
-        if (sz == Q::kWrapMarker) {
-            local_counter_ += (CapacityBytes - pos);
-            cached_commit_ = q_->write_commit_.v.load(std::memory_order_acquire);
-            return try_read(dst);
+            std::memcpy(dst.data(), base + sizeof(std::int32_t), payload_size);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (lapped(local_counter_)) {
+                resync();
+                return 0;
+            }
+
+            local_counter_ += frame_bytes;
+            static_cast<Derived*>(this)->publish_read(local_counter_);
+
+            return static_cast<std::int32_t>(payload_size);
         }
+    }
+
+    // Zero-copy drain: calls fn(std::span<const std::byte>) for every frame committed when the
+    // call starts (at most max_frames), with the span pointing straight into the ring. The span
+    // is only valid inside fn. One acquire load and one cursor update per batch.
+    // Returns the number of frames delivered.
+    // Lapping is only checked per batch, so with a DropOldest producer use try_read for
+    // validated copies.
+    template <class F>
+    std::size_t read_batch(F&& fn, std::size_t max_frames = std::numeric_limits<std::size_t>::max()) {
+        if (lapped(local_counter_)) resync();
+
+        const std::uint64_t commit = write_commit_->load(std::memory_order_acquire);
+        cached_commit_ = commit;
+
+        std::uint64_t cursor = local_counter_;
+        std::size_t frames = 0;
 
-        if (sz < 0) {
-            assert(false && "invalid frame size");
-            return 0;
+        while (cursor != commit && frames < max_frames) {
+            const std::size_t pos = static_cast<std::size_t>(cursor) & (CapacityBytes - 1);
+
+            if (pos + sizeof(std::int32_t) > CapacityBytes) {
+                cursor += (CapacityBytes - pos);
+                continue;
+            }
+
+            const std::byte* base = ptr_at(cursor);
+
+            std::int32_t sz = 0;
+            std::memcpy(&sz, base, sizeof(sz));
+
+            if (sz == kFastQueueWrapMarker) {
+                cursor += (CapacityBytes - pos);
+                continue;
+            }
+
+            const std::size_t payload_size = static_cast<std::size_t>(sz);
+            if (sz < 0 || payload_size > CapacityBytes) {
+                break;
+            }
+
+            fn(std::span<const std::byte>{ base + sizeof(std::int32_t), payload_size });
+
+            cursor += sizeof(std::int32_t) + align_up<BlockAlignment>(payload_size);
+            ++frames;
         }
 
-        const std::size_t payload_size = static_cast<std::size_t>(sz);
-        if (payload_size > dst.size()) {
-            return -static_cast<std::int32_t>(payload_size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (lapped(local_counter_)) {
+            resync();
+            return frames;
         }
 
-        const std::size_t padded_payload = align_up<BlockAlignment>(payload_size);
-        const std::size_t frame_bytes = sizeof(std::int32_t) + padded_payload;
+        local_counter_ = cursor;
+        static_cast<Derived*>(this)->publish_read(local_counter_);
+        return frames;
+    }
 
-        std::memcpy(dst.data(), base + sizeof(std::int32_t), payload_size);
-        local_counter_ += frame_bytes;
+    std::uint64_t consumed_bytes() const noexcept { return local_counter_; }
 
-        return static_cast<std::int32_t>(payload_size);
+    // True when nothing is committed past the read position (reloads the producer's commit).
+    bool empty() noexcept {
+        cached_commit_ = write_commit_->load(std::memory_order_acquire);
+        return local_counter_ == cached_commit_;
     }
 
-    std::uint64_t consumed_bytes() const noexcept { return local_counter_; }
+    // Times a DropOldest producer overwrote unread frames and the consumer skipped ahead.
+    std::uint64_t overruns() const noexcept { return overruns_; }
+
+protected:
+    FramedRingConsumer(const std::byte* buf, const std::atomic<std::uint64_t>& write_reserve,
+        const std::atomic<std::uint64_t>& write_commit, std::uint64_t start) noexcept
+        : buf_(buf), write_reserve_(&write_reserve), write_commit_(&write_commit),
+          local_counter_(start), cached_commit_(start) {
+    }
+
+    const std::byte* buf_;
+    const std::atomic<std::uint64_t>* write_reserve_;
+    const std::atomic<std::uint64_t>* write_commit_;
+    std::uint64_t local_counter_;
+    std::uint64_t cached_commit_;
+    std::uint64_t overruns_{ 0 };
 
 private:
-    using Q = FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
-    Q* q_;
-    std::uint64_t local_counter_{ 0 };
-    std::uint64_t cached_commit_{ 0 };
+    const std::byte* ptr_at(std::uint64_t counter) const noexcept {
+        return buf_ + (static_cast<std::size_t>(counter) & (CapacityBytes - 1));
+    }
+
+    // The producer may already be writing at or past counter + capacity.
+    bool lapped(std::uint64_t counter) const noexcept {
+        return write_reserve_->load(std::memory_order_acquire) - counter > CapacityBytes;
+    }
+
+    // Skip everything unread and continue from the newest committed frame.
+    void resync() noexcept {
+        ++overruns_;
+        local_counter_ = cached_commit_ = write_commit_->load(std::memory_order_acquire);
+        static_cast<Derived*>(this)->publish_read(local_counter_);
+    }
 };
 
+
+template < std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
+class FastQueueProducer
+    : public FramedRingProducer<FastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>, CapacityBytes, BlockAlignment, ReservePublishBlockBytes> {
+
+    using Base = FramedRingProducer<FastQueueProducer, CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
+    friend Base;
+
+public:
+    // Starts at the last committed frame, so a producer that restarts and attaches again continues
+    // the stream; a frame its predecessor reserved but never committed is overwritten.
+    explicit FastQueueProducer(FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>& q, OverflowPolicy policy = OverflowPolicy::SpinWait) noexcept
+        : Base(q.buf_, q.ctrl_->write_reserve_.v, q.ctrl_->write_commit_.v, policy,
+              q.ctrl_->write_commit_.v.load(std::memory_order_acquire),
+              q.ctrl_->write_reserve_.v.load(std::memory_order_acquire),
+              q.ctrl_->read_commit_.v.load(std::memory_order_acquire)),
+          ctrl_(q.ctrl_) {
+    }
+
+    // Bytes written but not consumed yet (reads the consumer's cache line).
+    std::uint64_t pending_bytes() const noexcept {
+        return this->local_counter_ - ctrl_->read_commit_.v.load(std::memory_order_acquire);
+    }
+
+private:
+    FastQueueControl* ctrl_;
+
+    std::uint64_t reader_position() const noexcept {
+        return ctrl_->read_commit_.v.load(std::memory_order_acquire);
+    }
+};
+
+
+template < std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes>
+class FastQueueConsumer
+    : public FramedRingConsumer<FastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>, CapacityBytes, BlockAlignment, ReservePublishBlockBytes> {
+
+    using Base = FramedRingConsumer<FastQueueConsumer, CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
+    friend Base;
+
+public:
+    // Starts at the last frame a consumer released, so one that restarts and attaches again reads
+    // on from there instead of resyncing past frames still pending.
+    explicit FastQueueConsumer(FastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes>& q) noexcept
+        : Base(q.buf_, q.ctrl_->write_reserve_.v, q.ctrl_->write_commit_.v,
+              q.ctrl_->read_commit_.v.load(std::memory_order_acquire)),
+          ctrl_(q.ctrl_) {
+    }
+
+private:
+    FastQueueControl* ctrl_;
+
+    void publish_read(std::uint64_t counter) noexcept {
+        ctrl_->read_commit_.v.store(counter, std::memory_order_release);
+    }
+};
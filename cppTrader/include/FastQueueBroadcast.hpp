@@ -0,0 +1,162 @@
+#pragma once
+
+// Single-producer / multi-consumer broadcast variant of FastQueue.
+// Every consumer sees every frame: one shared ring, the same framing code as FastQueue
+// (FramedRingProducer / FramedRingConsumer), and one cache-line-padded cursor per consumer.
+// The producer writes each frame once whatever the number of consumers, and only scans the
+// cursors when its cached view of the slowest one runs out.
+//
+// OverflowPolicy::SpinWait gates the producer on the slowest consumer; DropOldest never waits and
+// a consumer that was lapped resyncs to the newest frame (see overruns()).
+
+#include "FastQueue.hpp"
+
+#include <stdexcept>
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes, std::size_t MaxConsumers>
+class BroadcastFastQueueProducer;
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes, std::size_t MaxConsumers>
+class BroadcastFastQueueConsumer;
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment = 8, std::size_t ReservePublishBlockBytes = (1u << 12), std::size_t MaxConsumers = 8>
+class BroadcastFastQueue {
+    static_assert(is_pow2(CapacityBytes), "CapacityBytes must be power-of-two");
+    static_assert(is_pow2(BlockAlignment), "BlockAlignment must be power-of-two");
+    static_assert(BlockAlignment >= sizeof(std::int32_t), "BlockAlignment must be >= 4");
+    static_assert(is_pow2(ReservePublishBlockBytes), "ReservePublishBlockBytes must be power-of-two");
+    static_assert(ReservePublishBlockBytes <= CapacityBytes / 2, "ReservePublishBlockBytes must leave room in the ring");
+    static_assert(MaxConsumers > 0, "MaxConsumers must be > 0");
+
+public:
+    static constexpr std::int32_t kWrapMarker = kFastQueueWrapMarker;
+    static constexpr std::uint64_t kDetached = std::numeric_limits<std::uint64_t>::max();
+
+    BroadcastFastQueue()
+        : storage_(allocate_storage()) {
+        for (auto& c : cursors_) c.v.store(kDetached, std::memory_order_relaxed);
+    }
+
+    BroadcastFastQueue(const BroadcastFastQueue&) = delete;
+    BroadcastFastQueue& operator=(const BroadcastFastQueue&) = delete;
+
+    // Only one producer per queue.
+    BroadcastFastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers> make_producer(OverflowPolicy policy = OverflowPolicy::SpinWait) noexcept {
+        return BroadcastFastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>(*this, policy);
+    }
+
+    // Claims a cursor slot; the consumer starts at the newest committed frame and releases the
+    // slot when destroyed. Throws when all MaxConsumers slots are taken.
+    BroadcastFastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers> make_consumer() {
+        for (std::size_t i = 0; i < MaxConsumers; ++i) {
+            std::uint64_t expected = kDetached;
+            if (cursors_[i].v.compare_exchange_strong(expected, write_commit_.v.load(std::memory_order_acquire), std::memory_order_acq_rel)) {
+                // The producer may have moved on between that load and the claim; now that the
+                // slot holds us back, start from where it is.
+                const std::uint64_t start = write_commit_.v.load(std::memory_order_acquire);
+                cursors_[i].v.store(start, std::memory_order_release);
+                return BroadcastFastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>(*this, i, start);
+            }
+        }
+        throw std::runtime_error("BroadcastFastQueue: no free consumer slot");
+    }
+
+private:
+    friend class BroadcastFastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>;
+    friend class BroadcastFastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>;
+
+    PaddedAtomicU64 write_reserve_{};
+    PaddedAtomicU64 write_commit_{};
+    PaddedAtomicU64 cursors_[MaxConsumers];     // per-consumer read position, kDetached when free
+    FastQueueStorage storage_;
+
+    static FastQueueStorage allocate_storage() {
+        FastQueueStorage s;
+        s.capacity = CapacityBytes;
+        s.mask = CapacityBytes - 1;
+
+        void* p = ::operator new(CapacityBytes, std::align_val_t(kCacheLine));
+        std::memset(p, 0, CapacityBytes);
+
+        s.buf = { reinterpret_cast<std::byte*>(p), +[](void* q) {
+            ::operator delete(q, std::align_val_t(kCacheLine));
+        } };
+        return s;
+    }
+
+    // Slowest attached consumer, or `fallback` when nobody is attached.
+    std::uint64_t slowest_cursor(std::uint64_t fallback) const noexcept {
+        std::uint64_t slowest = kDetached;
+        for (const auto& c : cursors_) {
+            const std::uint64_t v = c.v.load(std::memory_order_acquire);
+            if (v < slowest) slowest = v;
+        }
+        return slowest == kDetached ? fallback : slowest;
+    }
+};
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes, std::size_t MaxConsumers>
+class BroadcastFastQueueProducer
+    : public FramedRingProducer<BroadcastFastQueueProducer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>,
+        CapacityBytes, BlockAlignment, ReservePublishBlockBytes> {
+
+    using Base = FramedRingProducer<BroadcastFastQueueProducer, CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
+    friend Base;
+
+public:
+    BroadcastFastQueueProducer(BroadcastFastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>& q, OverflowPolicy policy) noexcept
+        : Base(q.storage_.buf.get(), q.write_reserve_.v, q.write_commit_.v, policy, 0, 0, 0), q_(&q) {
+    }
+
+private:
+    using Q = BroadcastFastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>;
+    Q* q_;
+
+    // Slowest consumer; with none attached nothing holds the producer back.
+    std::uint64_t reader_position() const noexcept { return q_->slowest_cursor(this->local_counter_); }
+};
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment, std::size_t ReservePublishBlockBytes, std::size_t MaxConsumers>
+class BroadcastFastQueueConsumer
+    : public FramedRingConsumer<BroadcastFastQueueConsumer<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>,
+        CapacityBytes, BlockAlignment, ReservePublishBlockBytes> {
+
+    using Base = FramedRingConsumer<BroadcastFastQueueConsumer, CapacityBytes, BlockAlignment, ReservePublishBlockBytes>;
+    friend Base;
+
+public:
+    // Same reading contract as FastQueueConsumer (try_read, read_batch, overruns). Under
+    // DropOldest, read_batch spans may be overwritten while fn runs; the batch is then dropped
+    // and the consumer resyncs.
+    BroadcastFastQueueConsumer(BroadcastFastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>& q, std::size_t slot, std::uint64_t start) noexcept
+        : Base(q.storage_.buf.get(), q.write_reserve_.v, q.write_commit_.v, start), q_(&q), slot_(slot) {
+    }
+
+    BroadcastFastQueueConsumer(const BroadcastFastQueueConsumer&) = delete;
+    BroadcastFastQueueConsumer& operator=(const BroadcastFastQueueConsumer&) = delete;
+
+    BroadcastFastQueueConsumer(BroadcastFastQueueConsumer&& o) noexcept
+        : Base(o), q_(std::exchange(o.q_, nullptr)), slot_(o.slot_) {
+    }
+
+    BroadcastFastQueueConsumer& operator=(BroadcastFastQueueConsumer&&) = delete;
+
+    ~BroadcastFastQueueConsumer() {
+        if (q_) q_->cursors_[slot_].v.store(Q::kDetached, std::memory_order_release);
+    }
+
+    std::size_t slot() const noexcept { return slot_; }
+
+private:
+    using Q = BroadcastFastQueue<CapacityBytes, BlockAlignment, ReservePublishBlockBytes, MaxConsumers>;
+    Q* q_;
+    std::size_t slot_;
+
+    void publish_read(std::uint64_t counter) noexcept {
+        q_->cursors_[slot_].v.store(counter, std::memory_order_release);
+    }
+};
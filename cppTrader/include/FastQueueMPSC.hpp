@@ -0,0 +1,203 @@
+#pragma once
+
+// Multi-producer / single-consumer variant of FastQueue.
+// Same byte-framed, variable-size API; producers claim space with a CAS on write_reserve_ and
+// commit each frame individually through its header word, so there is no shared commit counter
+// and no mutex.
+
+#include "FastQueue.hpp"
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment>
+class MpscFastQueueProducer;
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment>
+class MpscFastQueueConsumer;
+
+
+// Frame layout: [u64 header][payload padded to BlockAlignment]
+// header = (lap << 32) | size, where lap = counter / CapacityBytes + 1. A frame is committed once
+// its header carries the lap the consumer is on. Frame boundaries move from lap to lap, so any
+// aligned word may become a header: the consumer zeroes every frame it has read before handing
+// the space back, and free space therefore never holds a word that looks committed.
+template <std::size_t CapacityBytes, std::size_t BlockAlignment = 8>
+class MpscFastQueue {
+    static_assert(is_pow2(CapacityBytes), "CapacityBytes must be power-of-two");
+    static_assert(is_pow2(BlockAlignment), "BlockAlignment must be power-of-two");
+    static_assert(BlockAlignment >= sizeof(std::uint64_t), "frame headers are 8-byte atomics");
+
+public:
+    static constexpr std::uint32_t kWrapMarker = 0xFFFFFFFFu;
+    static constexpr std::size_t kHeaderBytes = sizeof(std::uint64_t);
+
+    MpscFastQueue()
+        : storage_(allocate_storage()) {
+    }
+
+    MpscFastQueue(const MpscFastQueue&) = delete;
+    MpscFastQueue& operator=(const MpscFastQueue&) = delete;
+
+    // One producer handle per thread; handles are cheap and independent.
+    MpscFastQueueProducer<CapacityBytes, BlockAlignment> make_producer() noexcept {
+        return MpscFastQueueProducer<CapacityBytes, BlockAlignment>(*this);
+    }
+
+    MpscFastQueueConsumer<CapacityBytes, BlockAlignment> make_consumer() noexcept {
+        return MpscFastQueueConsumer<CapacityBytes, BlockAlignment>(*this);
+    }
+
+private:
+    friend class MpscFastQueueProducer<CapacityBytes, BlockAlignment>;
+    friend class MpscFastQueueConsumer<CapacityBytes, BlockAlignment>;
+
+    PaddedAtomicU64 write_reserve_{};   // next unclaimed byte, shared by producers
+    PaddedAtomicU64 read_commit_{};     // consumer position, read by producers only when they run out of room
+    FastQueueStorage storage_;
+
+    static FastQueueStorage allocate_storage() {
+        FastQueueStorage s;
+        s.capacity = CapacityBytes;
+        s.mask = CapacityBytes - 1;
+
+        void* p = ::operator new(CapacityBytes, std::align_val_t(kCacheLine));
+        std::memset(p, 0, CapacityBytes);
+
+        s.buf = { reinterpret_cast<std::byte*>(p), +[](void* q) {
+            ::operator delete(q, std::align_val_t(kCacheLine));
+        } };
+        return s;
+    }
+
+    static constexpr std::uint64_t lap_of(std::uint64_t counter) noexcept {
+        return (counter / CapacityBytes) + 1;
+    }
+
+    std::atomic_ref<std::uint64_t> header_at(std::uint64_t counter) noexcept {
+        auto* p = storage_.buf.get() + (static_cast<std::size_t>(counter) & storage_.mask);
+        return std::atomic_ref<std::uint64_t>(*reinterpret_cast<std::uint64_t*>(p));
+    }
+
+    std::byte* payload_at(std::uint64_t counter) noexcept {
+        return storage_.buf.get() + (static_cast<std::size_t>(counter) & storage_.mask) + kHeaderBytes;
+    }
+};
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment>
+class MpscFastQueueProducer {
+public:
+    explicit MpscFastQueueProducer(MpscFastQueue<CapacityBytes, BlockAlignment>& q) noexcept
+        : q_(&q) {
+    }
+
+    // Spins while the queue is full.
+    void write(std::span<const std::byte> payload) {
+        write_with(payload.size(), [&](std::span<std::byte> dst) {
+            std::memcpy(dst.data(), payload.data(), payload.size());
+            });
+    }
+
+    template <class F>
+    void write_with(std::size_t payload_size, F&& fill) {
+        while (!try_write_with(payload_size, fill)) {
+            cpu_relax();
+        }
+    }
+
+    // Returns false (and writes nothing) when the queue is full.
+    bool try_write(std::span<const std::byte> payload) {
+        return try_write_with(payload.size(), [&](std::span<std::byte> dst) {
+            std::memcpy(dst.data(), payload.data(), payload.size());
+            });
+    }
+
+    template <class F>
+    bool try_write_with(std::size_t payload_size, F&& fill) {
+        const std::size_t frame_bytes = Q::kHeaderBytes + align_up<BlockAlignment>(payload_size);
+        assert(frame_bytes <= CapacityBytes && "frame larger than the queue");
+
+        std::uint64_t start = q_->write_reserve_.v.load(std::memory_order_relaxed);
+        std::uint64_t skip = 0;
+
+        for (;;) {
+            const std::size_t pos = static_cast<std::size_t>(start) & (CapacityBytes - 1);
+            skip = (pos + frame_bytes > CapacityBytes) ? (CapacityBytes - pos) : 0;
+            const std::uint64_t end = start + skip + frame_bytes;
+
+            if (end - cached_read_ > CapacityBytes) {
+                cached_read_ = q_->read_commit_.v.load(std::memory_order_acquire);
+                if (end - cached_read_ > CapacityBytes) return false;
+            }
+
+            if (q_->write_reserve_.v.compare_exchange_weak(start, end, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        // The tail of the buffer is too short for this frame: mark it and start at offset 0.
+        if (skip) {
+            q_->header_at(start).store((Q::lap_of(start) << 32) | Q::kWrapMarker, std::memory_order_release);
+            start += skip;
+        }
+
+        fill(std::span<std::byte>{ q_->payload_at(start), payload_size });
+
+        q_->header_at(start).store((Q::lap_of(start) << 32) | static_cast<std::uint32_t>(payload_size), std::memory_order_release);
+        return true;
+    }
+
+private:
+    using Q = MpscFastQueue<CapacityBytes, BlockAlignment>;
+    Q* q_;
+    std::uint64_t cached_read_{ 0 };     // last consumer position this producer saw
+};
+
+
+template <std::size_t CapacityBytes, std::size_t BlockAlignment>
+class MpscFastQueueConsumer {
+public:
+    explicit MpscFastQueueConsumer(MpscFastQueue<CapacityBytes, BlockAlignment>& q) noexcept
+        : q_(&q) {
+    }
+
+    // Returns:
+    //  >0 : bytes copied into dst
+    //   0 : empty (or the next frame is claimed but not committed yet)
+    //  <0 : dst too small; required size is -return_value
+    std::int32_t try_read(std::span<std::byte> dst) {
+        for (;;) {
+            const std::uint64_t header = q_->header_at(local_counter_).load(std::memory_order_acquire);
+            if ((header >> 32) != Q::lap_of(local_counter_)) return 0;
+
+            const std::uint32_t sz = static_cast<std::uint32_t>(header);
+            if (sz == Q::kWrapMarker) {
+                // The rest of the tail was zeroed when last read; only the marker is new.
+                q_->header_at(local_counter_).store(0, std::memory_order_relaxed);
+                local_counter_ += CapacityBytes - (static_cast<std::size_t>(local_counter_) & (CapacityBytes - 1));
+                continue;
+            }
+
+            if (sz > dst.size()) {
+                return -static_cast<std::int32_t>(sz);
+            }
+
+            std::memcpy(dst.data(), q_->payload_at(local_counter_), sz);
+
+            // Stale payload must not read as a header next lap.
+            q_->header_at(local_counter_).store(0, std::memory_order_relaxed);
+            std::memset(q_->payload_at(local_counter_), 0, align_up<BlockAlignment>(sz));
+            local_counter_ += Q::kHeaderBytes + align_up<BlockAlignment>(sz);
+
+            // Frees the (zeroed) space for producers.
+            q_->read_commit_.v.store(local_counter_, std::memory_order_release);
+            return static_cast<std::int32_t>(sz);
+        }
+    }
+
+    std::uint64_t consumed_bytes() const noexcept { return local_counter_; }
+
+private:
+    using Q = MpscFastQueue<CapacityBytes, BlockAlignment>;
+    Q* q_;
+    std::uint64_t local_counter_{ 0 };
+};
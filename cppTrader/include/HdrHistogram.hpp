@@ -0,0 +1,278 @@
+#pragma once
+
+#include "common.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+// High-dynamic-range latency histogram (the HdrHistogram layout): values 1..highest are kept
+// with `significant_digits` decimal digits of precision, e.g. 3 digits = within 0.1%.
+// Recording is a leading-zero count, two shifts and an increment. Histograms with the same
+// configuration can be merged (one per thread, merged at report time) and encoded to a compact
+// byte string for offline comparison.
+class HdrHistogram {
+
+public:
+
+    static constexpr std::uint64_t kDefaultHighest = 3'600'000'000'000ull;   // one hour in ns
+
+    HdrHistogram()
+        : HdrHistogram(kDefaultHighest, 3) { }
+
+    HdrHistogram(std::uint64_t highest, int significant_digits)
+        : highest_(highest), digits_(significant_digits) {
+        if (significant_digits < 1 || significant_digits > 5) {
+            throw std::invalid_argument("HdrHistogram: significant_digits must be 1..5");
+        }
+        if (highest < 2) {
+            throw std::invalid_argument("HdrHistogram: highest must be >= 2");
+        }
+
+        std::uint64_t largest_single_unit = 2;
+        for (int i = 0; i < significant_digits; ++i) largest_single_unit *= 10;
+
+        sub_bucket_count_magnitude_ = static_cast<int>(std::bit_width(largest_single_unit - 1));
+        sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude_ - 1;
+        sub_bucket_count_ = std::uint64_t(1) << sub_bucket_count_magnitude_;
+        sub_bucket_half_count_ = sub_bucket_count_ / 2;
+        sub_bucket_mask_ = sub_bucket_count_ - 1;
+        leading_zero_count_base_ = 64 - sub_bucket_count_magnitude_;
+
+        int buckets = 1;
+        for (std::uint64_t smallest_untrackable = sub_bucket_count_; smallest_untrackable <= highest; ++buckets) {
+            if (smallest_untrackable > (std::numeric_limits<std::uint64_t>::max() >> 1)) {
+                ++buckets;
+                break;
+            }
+            smallest_untrackable <<= 1;
+        }
+        bucket_count_ = buckets;
+
+        counts_.assign(static_cast<std::size_t>(bucket_count_ + 1) * sub_bucket_half_count_, 0);
+    }
+
+    // Total number of recorded values (public, as on Log2Histogram).
+    std::uint64_t total = 0;
+
+    // Values above `highest` are clamped to it.
+    void add(std::uint64_t value, std::uint64_t count = 1) noexcept {
+        if (value > highest_) value = highest_;
+        counts_[counts_index_for(value)] += count;
+        total += count;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+        sum_ += static_cast<long double>(value) * count;
+    }
+
+    // Coordinated-omission correction for a producer that should emit one message every
+    // expected_interval: a stall of `value` also delayed the messages that were due meanwhile,
+    // so back-fill value - interval, value - 2*interval, ... down to the interval.
+    void add_corrected(std::uint64_t value, std::uint64_t expected_interval) noexcept {
+        add(value);
+        if (expected_interval == 0 || value <= expected_interval) return;
+
+        for (std::uint64_t missing = value - expected_interval; missing >= expected_interval; missing -= expected_interval) {
+            add(missing);
+        }
+    }
+
+    // Adds another histogram's counts. Both must have the same configuration.
+    void merge(const HdrHistogram& o) {
+        if (o.highest_ != highest_ || o.digits_ != digits_) {
+            throw std::invalid_argument("HdrHistogram: cannot merge histograms with different configurations");
+        }
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += o.counts_[i];
+        total += o.total;
+        sum_ += o.sum_;
+        if (o.min_ < min_) min_ = o.min_;
+        if (o.max_ > max_) max_ = o.max_;
+    }
+
+    void reset() noexcept {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total = 0;
+        sum_ = 0;
+        min_ = std::numeric_limits<std::uint64_t>::max();
+        max_ = 0;
+    }
+
+    // p in [0, 1]. Linearly interpolated inside the bucket holding the target rank, so the result
+    // is within the configured precision of the exact percentile.
+    std::uint64_t percentile(double p) const noexcept {
+        if (total == 0) return 0;
+        if (p <= 0.0) return min_;
+        if (p >= 1.0) return max_;
+
+        const double target = p * static_cast<double>(total);
+        std::uint64_t cumulative = 0;
+
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            const std::uint64_t c = counts_[i];
+            if (c == 0) continue;
+
+            if (static_cast<double>(cumulative + c) >= target) {
+                const std::uint64_t lo = value_from_index(i);
+                const std::uint64_t width = equivalent_range(lo);
+                const double frac = (target - static_cast<double>(cumulative)) / static_cast<double>(c);
+                const auto v = static_cast<std::uint64_t>(static_cast<double>(lo) + frac * static_cast<double>(width));
+                return std::clamp(v, min_, max_);
+            }
+            cumulative += c;
+        }
+        return max_;
+    }
+
+    std::uint64_t min_value() const noexcept { return total ? min_ : 0; }
+    std::uint64_t max_value() const noexcept { return max_; }
+    double mean() const noexcept { return total ? static_cast<double>(sum_ / total) : 0.0; }
+
+    std::uint64_t highest() const noexcept { return highest_; }
+    int significant_digits() const noexcept { return digits_; }
+
+    // Compact binary form: fixed header, then the counts array as zig-zag LEB128 varints where a
+    // negative number is a run of that many empty slots.
+    std::string encode() const {
+        std::string out;
+        put_u64(out, kMagic);
+        put_u64(out, highest_);
+        put_u64(out, static_cast<std::uint64_t>(digits_));
+        put_u64(out, total);
+        put_u64(out, min_);
+        put_u64(out, max_);
+
+        std::uint64_t mean_bits = 0;
+        const double m = mean();
+        std::memcpy(&mean_bits, &m, sizeof(m));
+        put_u64(out, mean_bits);
+
+        std::size_t used = counts_.size();
+        while (used > 0 && counts_[used - 1] == 0) --used;
+        put_u64(out, used);
+
+        for (std::size_t i = 0; i < used;) {
+            if (counts_[i] == 0) {
+                std::size_t run = 0;
+                while (i < used && counts_[i] == 0) { ++run; ++i; }
+                put_varint(out, -static_cast<std::int64_t>(run));
+            }
+            else {
+                put_varint(out, static_cast<std::int64_t>(counts_[i]));
+                ++i;
+            }
+        }
+        return out;
+    }
+
+    static HdrHistogram decode(std::string_view in) {
+        std::size_t pos = 0;
+        if (get_u64(in, pos) != kMagic) throw std::runtime_error("HdrHistogram: bad magic");
+
+        const std::uint64_t highest = get_u64(in, pos);
+        const int digits = static_cast<int>(get_u64(in, pos));
+        HdrHistogram h(highest, digits);
+
+        h.total = get_u64(in, pos);
+        h.min_ = get_u64(in, pos);
+        h.max_ = get_u64(in, pos);
+
+        const std::uint64_t mean_bits = get_u64(in, pos);
+        double m = 0.0;
+        std::memcpy(&m, &mean_bits, sizeof(m));
+        h.sum_ = static_cast<long double>(m) * h.total;
+
+        const std::uint64_t used = get_u64(in, pos);
+        if (used > h.counts_.size()) throw std::runtime_error("HdrHistogram: counts overflow the configuration");
+
+        for (std::size_t i = 0; i < used;) {
+            const std::int64_t v = get_varint(in, pos);
+            if (v < 0) {
+                i += static_cast<std::size_t>(-v);
+            }
+            else {
+                h.counts_[i++] = static_cast<std::uint64_t>(v);
+            }
+        }
+        return h;
+    }
+
+private:
+
+    static constexpr std::uint64_t kMagic = 0x3130'4D53'4948'5243ull;    // "CRHISM01"
+
+    std::uint64_t highest_;
+    int digits_;
+    int sub_bucket_count_magnitude_ = 0;
+    int sub_bucket_half_count_magnitude_ = 0;
+    int leading_zero_count_base_ = 0;
+    int bucket_count_ = 0;
+    std::uint64_t sub_bucket_count_ = 0;
+    std::uint64_t sub_bucket_half_count_ = 0;
+    std::uint64_t sub_bucket_mask_ = 0;
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t max_ = 0;
+    long double sum_ = 0;
+
+    int bucket_index(std::uint64_t value) const noexcept {
+        return leading_zero_count_base_ - std::countl_zero(value | sub_bucket_mask_);
+    }
+
+    std::size_t counts_index_for(std::uint64_t value) const noexcept {
+        const int bucket = bucket_index(value);
+        const std::uint64_t sub_bucket = value >> bucket;
+        return (static_cast<std::size_t>(bucket + 1) << sub_bucket_half_count_magnitude_)
+            + static_cast<std::size_t>(sub_bucket - sub_bucket_half_count_);
+    }
+
+    std::uint64_t value_from_index(std::size_t index) const noexcept {
+        int bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+        std::uint64_t sub_bucket = (index & (sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+        if (bucket < 0) {
+            sub_bucket -= sub_bucket_half_count_;
+            bucket = 0;
+        }
+        return sub_bucket << bucket;
+    }
+
+    // Width of the range of values that share value's slot.
+    std::uint64_t equivalent_range(std::uint64_t value) const noexcept {
+        const int bucket = bucket_index(value);
+        const std::uint64_t sub_bucket = value >> bucket;
+        return std::uint64_t(1) << (sub_bucket >= sub_bucket_count_ ? bucket + 1 : bucket);
+    }
+
+    static void put_u64(std::string& out, std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    static std::uint64_t get_u64(std::string_view in, std::size_t& pos) {
+        if (pos > in.size() || in.size() - pos < 8) throw std::runtime_error("HdrHistogram: truncated header");
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= std::uint64_t(static_cast<unsigned char>(in[pos + i])) << (8 * i);
+        pos += 8;
+        return v;
+    }
+
+    static void put_varint(std::string& out, std::int64_t v) {
+        std::uint64_t z = (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+        while (z >= 0x80) {
+            out.push_back(static_cast<char>((z & 0x7F) | 0x80));
+            z >>= 7;
+        }
+        out.push_back(static_cast<char>(z));
+    }
+
+    static std::int64_t get_varint(std::string_view in, std::size_t& pos) {
+        std::uint64_t z = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= in.size()) throw std::runtime_error("HdrHistogram: truncated counts");
+            const auto b = static_cast<unsigned char>(in[pos++]);
+            z |= std::uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+            }
+        }
+        throw std::runtime_error("HdrHistogram: bad varint");
+    }
+};
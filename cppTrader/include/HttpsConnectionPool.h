@@ -0,0 +1,114 @@
+#pragma once
+
+#include "common.h"
+#include "myboost.h"
+#include <deque>
+#include <memory>
+#include <span>
+
+// Pool of pre-warmed HTTP/1.1 keep-alive TLS connections to a single host.
+// Not thread safe: every member must be used from the executor it was created on.
+class HttpsConnectionPool {
+
+public:
+
+	using Request = http::request<http::string_body>;
+	using Response = http::response<http::string_body>;
+
+	// Outcome of one pipelined request; ec is set when no response was read for it.
+	struct PipelineResult {
+		Response response;
+		beast::error_code ec;
+	};
+
+	struct Config {
+		std::size_t connections = 2;                     // sockets kept warm
+		std::chrono::seconds io_timeout{ 10 };           // connect/handshake/write/read
+		std::chrono::seconds idle_refresh{ 45 };         // reconnect sockets idle longer than this
+		std::chrono::seconds health_interval{ 5 };       // maintenance period
+	};
+
+	HttpsConnectionPool(asio::any_io_executor iExecutor, ssl::context& iTlsCtx, std::string iHost, std::string iPort, Config iConfig);
+	HttpsConnectionPool(asio::any_io_executor iExecutor, ssl::context& iTlsCtx, std::string iHost, std::string iPort)
+		: HttpsConnectionPool(std::move(iExecutor), iTlsCtx, std::move(iHost), std::move(iPort), Config{}) { }
+
+	HttpsConnectionPool(const HttpsConnectionPool&) = delete;
+	HttpsConnectionPool& operator=(const HttpsConnectionPool&) = delete;
+
+	// Resolve once and open every connection up front so the first order does not pay for it.
+	awaitable<void> warm_up();
+
+	// Send one request on a pooled connection and read its response.
+	// A stale keep-alive socket is reconnected and the request retried once when that is safe.
+	awaitable<Response> request(const Request& req);
+
+	// Same as request() for a fully serialized request (see OrderSerializer). wire must stay
+	// valid until the returned awaitable completes. written_at, when given, gets the TscClock
+	// time the request bytes were handed to the socket.
+	awaitable<Response> request_raw(std::string_view wire, bool idempotent = false, std::uint64_t* written_at = nullptr);
+
+	// HTTP/1.1 pipelining: every pooled connection keeps up to iWindow requests in flight and
+	// responses come back in send order, so results[i] always answers requests[i].
+	// Requests already on the wire when a connection drops are failed, never resent.
+	awaitable<std::vector<PipelineResult>> pipeline(std::span<const Request> requests, std::size_t iWindow);
+
+	// Health checks and idle refresh; spawn once per pool.
+	awaitable<void> maintain_forever();
+
+	const std::string& host() const { return mHost; }
+	std::size_t size() const { return mConnections.size(); }
+	std::size_t open_count() const;
+
+private:
+
+	struct Connection {
+		std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream;
+		beast::flat_buffer buffer;
+		std::chrono::steady_clock::time_point last_used{};
+		std::uint64_t requests = 0;                      // served on the current socket
+		bool open = false;
+		bool busy = false;
+	};
+
+	// Returns a connection to the pool when the request scope ends (also on exceptions).
+	class Lease {
+	public:
+		Lease(HttpsConnectionPool& iPool, Connection& iConn) : mPool(iPool), mConn(iConn) { }
+		~Lease() { mPool.release(mConn); }
+		Connection& operator*() const { return mConn; }
+		Connection* operator->() const { return &mConn; }
+	private:
+		HttpsConnectionPool& mPool;
+		Connection& mConn;
+	};
+
+	struct PipelineBurst {
+		std::span<const Request> requests;
+		std::vector<PipelineResult>& results;
+		std::size_t window;
+		std::size_t next = 0;                            // first request not yet claimed by a worker
+	};
+
+	awaitable<void> pipeline_worker(PipelineBurst& burst);
+
+	template <class Writer>
+	awaitable<Response> exchange(Writer write, bool idempotent);
+
+	awaitable<void> resolve();
+	awaitable<void> connect(Connection& c);
+	void close(Connection& c);
+	bool is_stale(Connection& c) const;
+
+	awaitable<Connection*> acquire();
+	void release(Connection& c);
+
+	asio::any_io_executor mExecutor;
+	ssl::context& mTlsCtx;
+	std::string mHost;
+	std::string mPort;
+	Config mConfig;
+
+	tcp::resolver::results_type mEndpoints;
+	std::vector<std::unique_ptr<Connection>> mConnections;
+	asio::steady_timer mReleased;                        // wakes coroutines waiting for a free connection
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "common.h"
+#include "myboost.h"
+#include "Clock.h"
+#include "FastQueue.hpp"
+#include "HdrHistogram.hpp"
+#include "SharedMemory.h"
+#include <span>
+#include <thread>
+
+// Binary journal of FastQueue traffic, for post-mortems and replayed throughput tests.
+// A journal is a series of preallocated, memory-mapped segment files <dir>/<name>-NNNNNN.fqj.
+// Each segment starts with a JournalSegmentHeader page, followed by frames laid out like the
+// queue's own: the int32 length header, the TscClock time the frame was recorded, the payload
+// padded to 8 bytes. The header's used/frames counters are published after every batch, so a
+// crashed process leaves a readable journal up to its last batch.
+inline constexpr std::uint64_t kJournalMagic = 0x3130'4C4E'524A'5146ull;   // "FQJRNL01"
+inline constexpr std::uint32_t kJournalVersion = 1;
+inline constexpr std::size_t kJournalHeaderBytes = 4096;
+inline constexpr std::size_t kJournalAlignment = 8;
+
+struct JournalSegmentHeader {
+    std::uint64_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t header_bytes = 0;
+    std::uint64_t segment = 0;                      // index within the journal, from 0
+    std::uint64_t ticks_per_sec = 0;                // rate of the frame timestamps
+    std::atomic<std::uint64_t> used{ 0 };           // frame bytes after the header
+    std::atomic<std::uint64_t> frames{ 0 };
+};
+static_assert(sizeof(JournalSegmentHeader) <= kJournalHeaderBytes);
+
+struct JournalFrameHeader {
+    std::int32_t length = 0;                        // payload bytes, as in the FastQueue frame
+    std::uint32_t reserved = 0;
+    std::uint64_t ts = 0;                           // TscClock ticks when the frame was recorded
+};
+static_assert(sizeof(JournalFrameHeader) == 16);
+
+// Appends frames to the current segment and switches to a preallocated spare when it is full,
+// so rotation is a pointer swap; the next spare is created right after. Single threaded.
+// Opening a journal name that already exists in dir replaces it.
+class JournalWriter {
+
+public:
+
+    struct Config {
+        std::string dir = "journal";
+        std::string name = "queue";
+        std::size_t segment_bytes = std::size_t(64) << 20;
+    };
+
+    explicit JournalWriter(Config iConfig);
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Throws std::length_error for a frame that cannot fit in a segment.
+    void append(std::uint64_t ts, std::span<const std::byte> payload);
+
+    // Makes everything appended so far visible to readers of the current segment.
+    void publish() noexcept;
+
+    std::uint64_t frames() const noexcept { return mFrames; }
+    std::uint64_t bytes() const noexcept { return mBytes; }
+    std::uint64_t segments() const noexcept { return mIndex + 1; }
+
+    static std::string segment_path(const std::string& iDir, const std::string& iName, std::uint64_t iIndex);
+
+private:
+
+    MappedFile create_segment(std::uint64_t iIndex) const;
+    void rotate();
+
+    Config mConfig;
+    MappedFile mCurrent;
+    MappedFile mSpare;
+    std::uint64_t mIndex = 0;
+    std::size_t mUsed = 0;                          // frame bytes in mCurrent
+    std::uint64_t mSegmentFrames = 0;
+    std::uint64_t mFrames = 0;
+    std::uint64_t mBytes = 0;
+};
+
+// Read-only view of a whole journal. Frames are handed out as spans into the mappings.
+class JournalReader {
+
+public:
+
+    // Maps every segment of the journal; throws if there is none or one is not a journal.
+    JournalReader(const std::string& iDir, const std::string& iName);
+
+    // Calls fn(ts, payload) for every frame in order; the span stays valid while the reader lives.
+    template <class F>
+    std::uint64_t for_each(F&& fn) const {
+        std::uint64_t n = 0;
+        for (const MappedFile& seg : mSegments) {
+            const std::byte* p = seg.data() + kJournalHeaderBytes;
+            const std::byte* end = p + header(seg).used.load(std::memory_order_acquire);
+            while (p < end) {
+                JournalFrameHeader h;
+                std::memcpy(&h, p, sizeof(h));
+                if (h.length < 0 || std::size_t(end - p) < sizeof(h) + std::size_t(h.length)) break;
+
+                fn(h.ts, std::span<const std::byte>{ p + sizeof(h), std::size_t(h.length) });
+                p += sizeof(h) + align_up<kJournalAlignment>(std::size_t(h.length));
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    std::uint64_t frames() const noexcept { return mFrames; }
+    std::uint64_t bytes() const noexcept { return mBytes; }
+    std::size_t segments() const noexcept { return mSegments.size(); }
+    std::uint64_t ticks_per_sec() const noexcept { return mTicksPerSec; }
+    std::uint64_t first_ts() const noexcept { return mFirstTs; }
+    std::uint64_t last_ts() const noexcept { return mLastTs; }
+
+private:
+
+    static const JournalSegmentHeader& header(const MappedFile& seg) noexcept {
+        return *reinterpret_cast<const JournalSegmentHeader*>(seg.data());
+    }
+
+    std::vector<MappedFile> mSegments;
+    std::uint64_t mFrames = 0;
+    std::uint64_t mBytes = 0;
+    std::uint64_t mTicksPerSec = 0;
+    std::uint64_t mFirstTs = 0;
+    std::uint64_t mLastTs = 0;
+};
+
+// Journaling tap: record() costs the hot thread one timestamp and one memcpy into a private
+// staging FastQueue; a background thread drains it into a JournalWriter. When the staging ring
+// is full the frame is dropped and counted, unless the tap is lossless, in which case record()
+// waits for the journal thread.
+class JournalTap {
+
+public:
+
+    struct Config {
+        JournalWriter::Config journal;
+        bool lossless = false;
+    };
+
+    struct Stats {
+        std::uint64_t frames = 0;                   // written to the journal
+        std::uint64_t bytes = 0;
+        std::uint64_t dropped = 0;                  // staging ring full
+        std::uint64_t segments = 0;
+    };
+
+    explicit JournalTap(Config iConfig);
+    // Journals everything recorded so far, then closes the journal.
+    ~JournalTap();
+
+    JournalTap(const JournalTap&) = delete;
+    JournalTap& operator=(const JournalTap&) = delete;
+
+    // Hot side; one thread only.
+    void record(std::span<const std::byte> payload) {
+        const std::uint64_t ts = TscClock::now();
+        auto fill = [&](std::span<std::byte> dst) {
+            std::memcpy(dst.data(), &ts, sizeof(ts));
+            std::memcpy(dst.data() + sizeof(ts), payload.data(), payload.size());
+        };
+
+        if (mLossless) {
+            mStaging.write_with(sizeof(ts) + payload.size(), fill);
+        }
+        else if (!mStaging.try_write_with(sizeof(ts) + payload.size(), fill)) {
+            mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    Stats stats() const noexcept;
+
+private:
+
+    using StagingQueue = FastQueue<(1u << 22), 8, (1u << 12)>;
+
+    static JournalWriter::Config checked(JournalWriter::Config iConfig);
+    void run();
+    std::size_t drain();
+
+    StagingQueue mQueue;
+    FastQueueProducer<(1u << 22), 8, (1u << 12)> mStaging;
+    FastQueueConsumer<(1u << 22), 8, (1u << 12)> mDrain;
+    JournalWriter mWriter;
+    bool mLossless;
+
+    std::atomic<std::uint64_t> mDropped{ 0 };
+    std::atomic<std::uint64_t> mFrames{ 0 };
+    std::atomic<std::uint64_t> mBytes{ 0 };
+    std::atomic<std::uint64_t> mSegments{ 0 };
+    std::atomic<bool> mStop{ false };
+    boost::thread mThread;
+};
+
+// FastQueue producer that also records every committed frame on a JournalTap (null: no tap).
+// write/try_write copy after the commit, so journaling never delays the consumer.
+template <class Producer>
+class JournaledProducer {
+
+public:
+
+    JournaledProducer(Producer iProducer, JournalTap* iTap) noexcept
+        : mProducer(std::move(iProducer)), mTap(iTap) { }
+
+    void write(std::span<const std::byte> payload) {
+        mProducer.write(payload);
+        if (mTap) mTap->record(payload);
+    }
+
+    bool try_write(std::span<const std::byte> payload) {
+        if (!mProducer.try_write(payload)) return false;
+        if (mTap) mTap->record(payload);
+        return true;
+    }
+
+    // Once committed, the slot may be consumed and reused by another writer (MPSC) or lapped
+    // (DropOldest), so the tap copies the frame inside fill, before the commit.
+    template <class F>
+    void write_with(std::size_t payload_size, F&& fill) {
+        mProducer.write_with(payload_size, [&](std::span<std::byte> dst) {
+            fill(dst);
+            if (mTap) mTap->record(dst);
+            });
+    }
+
+    Producer& producer() noexcept { return mProducer; }
+
+private:
+
+    Producer mProducer;
+    JournalTap* mTap;
+};
+
+enum class ReplayPacing : std::uint8_t {
+    MaxSpeed,           // back to back, as fast as the consumer drains
+    Original,           // the recorded inter-frame gaps, divided by speed
+};
+
+struct ReplayStats {
+    std::uint64_t frames = 0;
+    std::uint64_t bytes = 0;
+    double seconds = 0.0;
+    HdrHistogram lateness;                          // ns behind the recorded schedule (Original only)
+};
+
+// Feeds a journal back through a FastQueue producer, each frame copied straight from the
+// mapping into the ring.
+template <class Producer>
+ReplayStats replay_journal(const JournalReader& iJournal, Producer& iProducer, ReplayPacing iPacing, double iSpeed = 1.0)
+{
+    ReplayStats st;
+    const long double ns_per_tick = 1e9L / (long double)iJournal.ticks_per_sec() / (long double)iSpeed;
+    const std::uint64_t first = iJournal.first_ts();
+
+    const std::uint64_t t0 = TscClock::now();
+    iJournal.for_each([&](std::uint64_t ts, std::span<const std::byte> payload) {
+        if (iPacing == ReplayPacing::Original) {
+            const std::uint64_t due = static_cast<std::uint64_t>((long double)(ts - first) * ns_per_tick);
+            std::uint64_t now = TscClock::to_ns(TscClock::now() - t0);
+
+            // Sleep through long gaps, spin the last stretch.
+            if (due > now + 2'000'000) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - 1'000'000));
+            while ((now = TscClock::to_ns(TscClock::now() - t0)) < due) cpu_relax();
+            st.lateness.add(now - due);
+        }
+
+        iProducer.write(payload);
+        ++st.frames;
+        st.bytes += payload.size();
+        });
+
+    st.seconds = double(TscClock::to_ns(TscClock::now() - t0)) / 1e9;
+    return st;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "common.h"
+#include <bit>
+#include <charconv>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPPTRADER_HAS_SSE2 1
+#else
+#define CPPTRADER_HAS_SSE2 0
+#endif
+
+// Lexing primitives shared by the schema-aware stream decoders (TradeUpdateDecoder,
+// MarketDataDecoder). Everything works on [p, end) of the frame bytes and returns nullptr on
+// malformed input; strings come back as views with escapes left in place.
+struct JsonScan {
+
+    static double as_double(std::string_view s) noexcept {
+        double v = 0.0;
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        return v;
+    }
+
+    static std::uint64_t as_u64(std::string_view s) noexcept {
+        // Quantities may arrive as "10" or "10.0"; from_chars stops at the '.'.
+        std::uint64_t v = 0;
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        return v;
+    }
+
+    static const char* skip_ws(const char* p, const char* end) noexcept {
+        while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+        return p;
+    }
+
+    // First '"' or '\\' at or after p (end if none).
+    static const char* find_string_delim(const char* p, const char* end) noexcept {
+#if CPPTRADER_HAS_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i bslash = _mm_set1_epi8('\\');
+        for (; end - p >= 16; p += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            if (mask) return p + std::countr_zero(mask);
+        }
+#endif
+        for (; p != end; ++p) {
+            if (*p == '"' || *p == '\\') return p;
+        }
+        return end;
+    }
+
+    // First '"', '{', '}', '[' or ']' at or after p (end if none).
+    static const char* find_structural(const char* p, const char* end) noexcept {
+#if CPPTRADER_HAS_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i lbrace = _mm_set1_epi8('{');
+        const __m128i rbrace = _mm_set1_epi8('}');
+        const __m128i lbrack = _mm_set1_epi8('[');
+        const __m128i rbrack = _mm_set1_epi8(']');
+        for (; end - p >= 16; p += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hit = _mm_cmpeq_epi8(v, quote);
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, lbrace));
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, rbrace));
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, lbrack));
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, rbrack));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            if (mask) return p + std::countr_zero(mask);
+        }
+#endif
+        for (; p != end; ++p) {
+            const char c = *p;
+            if (c == '"' || c == '{' || c == '}' || c == '[' || c == ']') return p;
+        }
+        return end;
+    }
+
+    // p at the opening quote; returns one past the closing quote or nullptr.
+    static const char* read_string(const char* p, const char* end, std::string_view& out) noexcept {
+        const char* q = p + 1;
+        for (;;) {
+            q = find_string_delim(q, end);
+            if (q == end) return nullptr;
+            if (*q == '"') break;
+            q += 2;                                     // skip the escaped character
+            if (q >= end) return nullptr;
+        }
+        out = std::string_view(p + 1, static_cast<std::size_t>(q - (p + 1)));
+        return q + 1;
+    }
+
+    // p at '{' or '['; returns one past the matching close or nullptr.
+    static const char* skip_container(const char* p, const char* end) noexcept {
+        std::size_t depth = 0;
+        for (;;) {
+            p = find_structural(p, end);
+            if (p == end) return nullptr;
+
+            switch (*p) {
+            case '"': {
+                std::string_view ignored;
+                p = read_string(p, end, ignored);
+                if (!p) return nullptr;
+                continue;
+            }
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            default:
+                if (--depth == 0) return p + 1;
+                break;
+            }
+            ++p;
+        }
+    }
+
+    // Numbers, true/false/null, strings or containers.
+    static const char* skip_value(const char* p, const char* end, std::string_view& scalar) noexcept {
+        if (*p == '"') return read_string(p, end, scalar);
+        if (*p == '{' || *p == '[') return skip_container(p, end);
+
+        const char* b = p;
+        while (p != end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') ++p;
+        scalar = std::string_view(b, static_cast<std::size_t>(p - b));
+        return p;
+    }
+};
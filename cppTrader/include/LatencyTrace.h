@@ -0,0 +1,174 @@
+#pragma once
+
+#include "common.h"
+#include "Benchmark.h"
+#include <algorithm>
+#include <iomanip>
+
+// Tick-to-trade stages, in pipeline order:
+//   FrameReceived : WebSocket frame read (run_one_session)
+//   Decoded       : trade update decoded (TradeUpdatePublisher)
+//   Enqueued      : committed to the TradeUpdateQueue
+//   Dequeued      : picked up by the strategy thread, which issues the order
+//   Serialized    : HTTP request built (OrderSerializer)
+//   Written       : request bytes handed to the socket
+//   Acked         : HTTP response read
+enum class TraceStage : std::uint8_t { FrameReceived, Decoded, Enqueued, Dequeued, Serialized, Written, Acked };
+
+constexpr std::size_t kTraceStages = 7;
+
+static inline const char* to_string(TraceStage s)
+{
+    switch (s) {
+    case TraceStage::FrameReceived: return "frame";
+    case TraceStage::Decoded: return "decoded";
+    case TraceStage::Enqueued: return "enqueued";
+    case TraceStage::Dequeued: return "dequeued";
+    case TraceStage::Serialized: return "serialized";
+    case TraceStage::Written: return "written";
+    case TraceStage::Acked: return "acked";
+    }
+    return "?";
+}
+
+// Raw TscClock stamps of one order, keyed by its correlation id (the OrderMsg seq, which also
+// ends up in client_order_id).
+struct TraceRecord {
+    std::uint64_t id = 0;
+    std::uint64_t ts[kTraceStages]{};
+
+    std::uint64_t at(TraceStage s) const { return ts[static_cast<std::size_t>(s)]; }
+};
+
+// Per-stage latency breakdown. A stamp is one clock read and a store into a fixed slot, so it
+// is cheap enough for every order; histograms are only touched in complete().
+// Each record is written by one thread at a time and handed on through the pipeline's queues,
+// which order the stamps. complete() and the report must stay on one thread.
+class LatencyTracer {
+
+public:
+
+    static constexpr std::size_t kSlots = 1u << 16;      // > orders in flight
+    static constexpr std::size_t kSlowest = 16;
+
+    LatencyTracer() : mRecords(kSlots) { }
+
+    LatencyTracer(const LatencyTracer&) = delete;
+    LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+    // Opens the record for `id` with the stamps taken upstream of the order.
+    void begin(std::uint64_t id, std::uint64_t ts_frame, std::uint64_t ts_decoded, std::uint64_t ts_enqueued, std::uint64_t ts_dequeued) noexcept {
+        TraceRecord& r = slot(id);
+        r = TraceRecord{};
+        r.id = id;
+        r.ts[0] = ts_frame;
+        r.ts[1] = ts_decoded;
+        r.ts[2] = ts_enqueued;
+        r.ts[3] = ts_dequeued;
+    }
+
+    // Ignored for ids that were never begun (e.g. orders not triggered by a frame).
+    void stamp(std::uint64_t id, TraceStage s, std::uint64_t ts = qpc_now()) noexcept {
+        TraceRecord& r = slot(id);
+        if (r.id == id) r.ts[static_cast<std::size_t>(s)] = ts;
+    }
+
+    // Records every stage delta of a fully stamped record and keeps it if it is among the slowest.
+    void complete(std::uint64_t id) {
+        TraceRecord& r = slot(id);
+        if (r.id != id) return;
+        for (const std::uint64_t t : r.ts) {
+            if (t == 0) return;
+        }
+
+        for (std::size_t i = 1; i < kTraceStages; ++i) {
+            mStage[i].add(ns_between(r.ts[i - 1], r.ts[i]));
+        }
+        mTickToTrade.add(ns_between(r.at(TraceStage::FrameReceived), r.at(TraceStage::Written)));
+        const std::uint64_t total = ns_between(r.at(TraceStage::FrameReceived), r.at(TraceStage::Acked));
+        mTickToAck.add(total);
+        ++mCompleted;
+
+        keep_if_slow(r, total);
+        r.id = 0;
+    }
+
+    std::uint64_t completed() const noexcept { return mCompleted; }
+
+    // Histogram of `s` minus the previous stage (FrameReceived has none).
+    const HdrHistogram& stage(TraceStage s) const noexcept { return mStage[static_cast<std::size_t>(s)]; }
+    const HdrHistogram& tick_to_trade() const noexcept { return mTickToTrade; }
+    const HdrHistogram& tick_to_ack() const noexcept { return mTickToAck; }
+
+    // Slowest complete records by frame -> ack, slowest first.
+    std::vector<TraceRecord> slowest() const {
+        std::vector<TraceRecord> out = mSlowest;
+        std::sort(out.begin(), out.end(), [](const TraceRecord& a, const TraceRecord& b) {
+            return a.at(TraceStage::Acked) - a.at(TraceStage::FrameReceived) > b.at(TraceStage::Acked) - b.at(TraceStage::FrameReceived);
+            });
+        return out;
+    }
+
+    void print_report(std::ostream& os, std::size_t iSlowest = 5) const {
+        const std::uint64_t total_p50 = mTickToAck.percentile(0.50);
+
+        os << "  " << std::left << std::setw(28) << "stage" << std::right << std::setw(8) << "n" << std::setw(11) << "p50"
+            << std::setw(11) << "p99" << std::setw(11) << "p99.9" << std::setw(11) << "max" << std::setw(12) << "p50 share\n";
+        for (std::size_t i = 1; i < kTraceStages; ++i) {
+            const std::string name = std::string(to_string(TraceStage(i - 1))) + " -> " + to_string(TraceStage(i));
+            print_row(os, name, mStage[i], total_p50);
+        }
+        print_row(os, "tick-to-trade (-> written)", mTickToTrade, total_p50);
+        print_row(os, "tick-to-ack", mTickToAck, total_p50);
+
+        const auto slow = slowest();
+        if (slow.empty() || iSlowest == 0) return;
+
+        os << "\nSlowest orders (ns per stage):\n";
+        for (std::size_t k = 0; k < std::min(iSlowest, slow.size()); ++k) {
+            const TraceRecord& r = slow[k];
+            os << "  id=" << r.id << " total=" << ns_between(r.at(TraceStage::FrameReceived), r.at(TraceStage::Acked));
+            for (std::size_t i = 1; i < kTraceStages; ++i) {
+                os << " " << to_string(TraceStage(i)) << "=" << ns_between(r.ts[i - 1], r.ts[i]);
+            }
+            os << "\n";
+        }
+    }
+
+private:
+
+    TraceRecord& slot(std::uint64_t id) noexcept { return mRecords[id & (kSlots - 1)]; }
+
+    static std::uint64_t ns_between(std::uint64_t from, std::uint64_t to) noexcept {
+        return (to > from) ? TscClock::to_ns(to - from) : 0;
+    }
+
+    void keep_if_slow(const TraceRecord& r, std::uint64_t total) {
+        if (mSlowest.size() < kSlowest) {
+            mSlowest.push_back(r);
+            return;
+        }
+        auto fastest = std::min_element(mSlowest.begin(), mSlowest.end(), [](const TraceRecord& a, const TraceRecord& b) {
+            return a.at(TraceStage::Acked) - a.at(TraceStage::FrameReceived) < b.at(TraceStage::Acked) - b.at(TraceStage::FrameReceived);
+            });
+        if (total > ns_between(fastest->at(TraceStage::FrameReceived), fastest->at(TraceStage::Acked))) *fastest = r;
+    }
+
+    static void print_row(std::ostream& os, const std::string& name, const HdrHistogram& h, std::uint64_t total_p50) {
+        const double share = total_p50 ? 100.0 * double(h.percentile(0.50)) / double(total_p50) : 0.0;
+        os << "  " << std::left << std::setw(28) << name << std::right
+            << std::setw(8) << h.total
+            << std::setw(11) << h.percentile(0.50)
+            << std::setw(11) << h.percentile(0.99)
+            << std::setw(11) << h.percentile(0.999)
+            << std::setw(11) << h.max_value()
+            << std::setw(10) << std::fixed << std::setprecision(1) << share << "%\n" << std::defaultfloat;
+    }
+
+    std::vector<TraceRecord> mRecords;
+    HdrHistogram mStage[kTraceStages];
+    HdrHistogram mTickToTrade;
+    HdrHistogram mTickToAck;
+    std::uint64_t mCompleted = 0;
+    std::vector<TraceRecord> mSlowest;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "JsonScan.h"
+
+// Alpaca stocks stream (v2/iex, v2/sip) message kinds.
+enum class MarketDataType : std::uint8_t { Other = 0, Trade, Quote, Bar };
+
+// One stocks-stream message; fields are views into the frame bytes, numbers left as text.
+// Field names on the wire: T type, S symbol, t timestamp; trades p/s; quotes bp/bs/ap/as;
+// bars o/h/l/c/v ("c" is the condition array on trades, which is skipped).
+struct MarketDataView {
+    MarketDataType type = MarketDataType::Other;
+    std::string_view type_name;         // "t", "q", "b", "u", "d", or "success"/"subscription"/"error"
+    std::string_view symbol;
+    std::string_view timestamp;
+
+    std::string_view price;             // trade
+    std::string_view size;
+
+    std::string_view bid_price;         // quote
+    std::string_view bid_size;
+    std::string_view ask_price;
+    std::string_view ask_size;
+
+    std::string_view open;              // bar (minute, updated and daily)
+    std::string_view high;
+    std::string_view low;
+    std::string_view close;
+    std::string_view volume;
+
+    std::string_view msg;               // control messages: "connected", "authenticated", ...
+};
+
+// Allocation-free decoder for stocks-stream frames, which are JSON arrays of flat objects:
+// [{"T":"q","S":"AAPL","bp":189.1,"bs":3,"ap":189.12,"as":1,"t":"..."}, {"T":"t",...}]
+class MarketDataDecoder : private JsonScan {
+
+public:
+
+    // Calls on_message for every object in the frame (data and control alike) and returns how
+    // many were data (trade/quote/bar). Stops at the first malformed element.
+    template <class F>
+    static std::size_t for_each(std::string_view frame, F&& on_message) {
+        const char* end = frame.data() + frame.size();
+        const char* p = skip_ws(frame.data(), end);
+        if (p == end) return 0;
+
+        std::size_t n = 0;
+        MarketDataView v;
+
+        if (*p == '{') {
+            if (!parse_object(p, end, v)) return 0;
+            on_message(v);
+            return v.type != MarketDataType::Other ? 1 : 0;
+        }
+        if (*p != '[') return 0;
+
+        p = skip_ws(p + 1, end);
+        while (p != end && *p == '{') {
+            v = {};
+            p = parse_object(p, end, v);
+            if (!p) break;
+            on_message(v);
+            if (v.type != MarketDataType::Other) ++n;
+
+            p = skip_ws(p, end);
+            if (p != end && *p == ',') p = skip_ws(p + 1, end);
+        }
+        return n;
+    }
+
+    using JsonScan::as_double;
+    using JsonScan::as_u64;
+
+private:
+
+    static MarketDataType type_of(std::string_view t) noexcept {
+        if (t.size() != 1) return MarketDataType::Other;
+        switch (t[0]) {
+        case 't': return MarketDataType::Trade;
+        case 'q': return MarketDataType::Quote;
+        case 'b':
+        case 'u':
+        case 'd': return MarketDataType::Bar;
+        default: return MarketDataType::Other;
+        }
+    }
+
+    static std::string_view* field_slot(std::string_view key, MarketDataView& out) noexcept {
+        switch (key.size()) {
+        case 1:
+            switch (key[0]) {
+            case 'T': return &out.type_name;
+            case 'S': return &out.symbol;
+            case 't': return &out.timestamp;
+            case 'p': return &out.price;
+            case 's': return &out.size;
+            case 'o': return &out.open;
+            case 'h': return &out.high;
+            case 'l': return &out.low;
+            case 'c': return &out.close;
+            case 'v': return &out.volume;
+            default: return nullptr;
+            }
+        case 2:
+            if (key == "bp") return &out.bid_price;
+            if (key == "bs") return &out.bid_size;
+            if (key == "ap") return &out.ask_price;
+            if (key == "as") return &out.ask_size;
+            return nullptr;
+        case 3:
+            return key == "msg" ? &out.msg : nullptr;
+        default:
+            return nullptr;
+        }
+    }
+
+    // p at '{'; returns one past the closing '}' or nullptr.
+    static const char* parse_object(const char* p, const char* end, MarketDataView& out) noexcept {
+        p = skip_ws(p + 1, end);
+        if (p != end && *p == '}') return p + 1;
+
+        for (;;) {
+            if (p == end || *p != '"') return nullptr;
+
+            std::string_view key;
+            p = read_string(p, end, key);
+            if (!p) return nullptr;
+
+            p = skip_ws(p, end);
+            if (p == end || *p != ':') return nullptr;
+            p = skip_ws(p + 1, end);
+            if (p == end) return nullptr;
+
+            // Containers (trade conditions) leave the scalar empty.
+            std::string_view value;
+            p = skip_value(p, end, value);
+            if (!p) return nullptr;
+            if (std::string_view* slot = field_slot(key, out)) *slot = value;
+
+            p = skip_ws(p, end);
+            if (p == end) return nullptr;
+            if (*p == '}') break;
+            if (*p != ',') return nullptr;
+            p = skip_ws(p + 1, end);
+        }
+
+        out.type = type_of(out.type_name);
+        return p + 1;
+    }
+};
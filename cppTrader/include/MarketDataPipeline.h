@@ -0,0 +1,82 @@
+#pragma once
+
+#include "common.h"
+#include "Benchmark.h"
+#include "MarketDataDecoder.h"
+#include "QuoteCache.h"
+
+// Stocks-stream reader -> QuoteCache. Unlike trade updates there is no queue: the seqlocked
+// records are the hand-off, and strategies always read the latest state.
+
+// Network-thread side counters. Written only by the reader coroutine.
+struct MarketDataPublisherStats {
+    HdrHistogram publish;      // frame received -> last record of the frame published (ns)
+    std::uint64_t frames = 0;
+    std::uint64_t trades = 0;
+    std::uint64_t quotes = 0;
+    std::uint64_t bars = 0;
+    std::uint64_t unknown_symbols = 0;  // data for a symbol that is not interned or past the cache
+    std::uint64_t other = 0;            // success / subscription / error messages
+};
+
+template <class Cache>
+class MarketDataPublisher {
+
+public:
+
+    MarketDataPublisher(Cache& iCache, std::uint64_t iFreq, const SymbolTable& iSymbols = SymbolTable::getInstance())
+        : mCache(iCache), mFreq(iFreq), mSymbols(iSymbols) { }
+
+    // Decodes every message in the frame into the cache. Returns how many were trades, quotes
+    // or bars; 0 means a control frame, which the caller handles itself.
+    std::size_t publish_frame(std::string_view frame, std::uint64_t ts_recv)
+    {
+        ++mStats.frames;
+
+        const std::size_t n = MarketDataDecoder::for_each(frame, [&](const MarketDataView& v) {
+            if (v.type == MarketDataType::Other) {
+                ++mStats.other;
+                return;
+            }
+
+            const SymbolId id = mSymbols.find(v.symbol);
+            if (!mCache.contains(id)) {
+                ++mStats.unknown_symbols;
+                return;
+            }
+
+            switch (v.type) {
+            case MarketDataType::Quote:
+                ++mStats.quotes;
+                mCache.update_quote(id,
+                    MarketDataDecoder::as_double(v.bid_price), static_cast<std::uint32_t>(MarketDataDecoder::as_u64(v.bid_size)),
+                    MarketDataDecoder::as_double(v.ask_price), static_cast<std::uint32_t>(MarketDataDecoder::as_u64(v.ask_size)),
+                    ts_recv);
+                break;
+            case MarketDataType::Trade:
+                ++mStats.trades;
+                mCache.update_trade(id, MarketDataDecoder::as_double(v.price),
+                    static_cast<std::uint32_t>(MarketDataDecoder::as_u64(v.size)), ts_recv);
+                break;
+            case MarketDataType::Bar:
+                ++mStats.bars;
+                mCache.update_bar(id, MarketDataDecoder::as_double(v.close), MarketDataDecoder::as_u64(v.volume), ts_recv);
+                break;
+            default:
+                break;
+            }
+            });
+
+        if (n > 0) mStats.publish.add(ticks_to_ns(qpc_now() - ts_recv, mFreq));
+        return n;
+    }
+
+    const MarketDataPublisherStats& stats() const { return mStats; }
+
+private:
+
+    Cache& mCache;
+    std::uint64_t mFreq;
+    const SymbolTable& mSymbols;
+    MarketDataPublisherStats mStats;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common.h"
+#include "myboost.h"
+#include <deque>
+#include <memory>
+#include <random>
+
+// In-process stand-in for the Alpaca paper endpoint, for reproducible offline benchmarks.
+// One TLS listener serves both protocols, like paper-api.alpaca.markets:
+//   GET  /v2/account     account snapshot
+//   POST /v2/orders      accepts the order, answers with the order object
+//   GET  /stream         trade_updates WebSocket (auth, listen, then new + fill per order)
+// Every HTTP response is held back by latency + uniform jitter; fills follow the ack after
+// fill_delay. The certificate is self-signed for "localhost" and generated at start-up;
+// clients trust it through certificate_pem().
+// Not thread safe: run it on its own io_context thread.
+class MockAlpacaServer {
+
+public:
+
+	struct Config {
+		std::string address = "127.0.0.1";
+		unsigned short port = 0;                         // 0 = any free port, see port()
+		std::chrono::microseconds latency{ 200 };        // added before every REST response
+		std::chrono::microseconds jitter{ 50 };          // + uniform [0, jitter]
+		std::chrono::microseconds fill_delay{ 100 };     // ack -> "fill" on trade_updates
+		double fill_price = 100.0;
+		double cash = 100000.0;
+	};
+
+	struct Stats {
+		std::uint64_t connections = 0;
+		std::uint64_t orders = 0;
+		std::uint64_t fills = 0;
+		std::uint64_t rejected = 0;                      // 4xx answers
+	};
+
+	MockAlpacaServer(asio::any_io_executor iExecutor, Config iConfig);
+	explicit MockAlpacaServer(asio::any_io_executor iExecutor)
+		: MockAlpacaServer(std::move(iExecutor), Config{}) { }
+	~MockAlpacaServer();
+
+	MockAlpacaServer(const MockAlpacaServer&) = delete;
+	MockAlpacaServer& operator=(const MockAlpacaServer&) = delete;
+
+	// Binds, listens and spawns the accept loop. Throws beast::system_error when the address is
+	// taken.
+	void start();
+
+	// Closes the listener; sessions end when their peers disconnect.
+	void stop();
+
+	unsigned short port() const { return mPort; }
+	const std::string& certificate_pem() const { return mCertPem; }
+	const Stats& stats() const { return mStats; }
+
+private:
+
+	class StreamSession;
+
+	awaitable<void> accept_forever();
+	awaitable<void> serve(tcp::socket iSocket);
+
+	// REST routes. post_order also returns the accepted order, to be filled once the ack is out.
+	http::response<http::string_body> handle(const http::request<http::string_body>& iReq);
+	http::response<http::string_body> post_order(const http::request<http::string_body>& iReq, nlohmann::json& accepted);
+
+	std::chrono::microseconds next_delay();
+	void schedule_fill(nlohmann::json iOrder);
+	void broadcast(const std::string& iFrame);
+
+	void make_certificate();
+
+	asio::any_io_executor mExecutor;
+	Config mConfig;
+	ssl::context mTlsCtx;
+	tcp::acceptor mAcceptor;
+	unsigned short mPort = 0;
+
+	std::string mCertPem;
+	std::minstd_rand mRng{ 42 };
+	std::uint64_t mOrderSeq = 0;
+	Stats mStats;
+
+	std::vector<std::weak_ptr<StreamSession>> mListeners;   // sessions subscribed to trade_updates
+};
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "common.h"
+#include "SeqLock.h"
+#include "SymbolTable.h"
+#include "OrderType.h"
+#include "OrderSerializer.h"
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+
+// Life cycle of one of our orders. Filled, Canceled and Rejected are terminal.
+enum class OrderState : std::uint8_t {
+    Free = 0,           // pool slot not in use / order not tracked
+    PendingNew,         // sent, no trade_updates event yet
+    Accepted,           // "new"
+    PartiallyFilled,
+    Filled,
+    Canceled,           // canceled, expired, done_for_day or replaced
+    Rejected,           // rejected by the broker, or the POST itself failed
+};
+
+static inline const char* order_state_name(OrderState s) noexcept
+{
+    switch (s) {
+    case OrderState::PendingNew: return "pending_new";
+    case OrderState::Accepted: return "accepted";
+    case OrderState::PartiallyFilled: return "partially_filled";
+    case OrderState::Filled: return "filled";
+    case OrderState::Canceled: return "canceled";
+    case OrderState::Rejected: return "rejected";
+    default: return "free";
+    }
+}
+
+static constexpr bool is_terminal(OrderState s) noexcept
+{
+    return s == OrderState::Filled || s == OrderState::Canceled || s == OrderState::Rejected;
+}
+
+// State after applying event to an open order in state s; s itself when the event does not move
+// it (pending_cancel, duplicates). Free means the event is not legal from s.
+static constexpr OrderState next_order_state(OrderState s, TradeEvent event) noexcept
+{
+    if (s == OrderState::Free || is_terminal(s)) return OrderState::Free;
+
+    switch (event) {
+    case TradeEvent::New:
+        return (s == OrderState::PendingNew) ? OrderState::Accepted : s;
+    case TradeEvent::PartialFill:
+        return OrderState::PartiallyFilled;
+    case TradeEvent::Fill:
+        return OrderState::Filled;
+    case TradeEvent::Canceled:
+    case TradeEvent::Expired:
+    case TradeEvent::DoneForDay:
+    case TradeEvent::Replaced:
+        return OrderState::Canceled;
+    case TradeEvent::Rejected:
+        return (s == OrderState::PendingNew || s == OrderState::Accepted) ? OrderState::Rejected : OrderState::Free;
+    default:
+        return s;
+    }
+}
+
+// Tag that keeps this process's client_order_ids apart from every earlier session's (Alpaca
+// wants them unique per account): start time in ms, base 36, then 16 random bits in hex.
+inline std::string make_session_tag()
+{
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const unsigned salt = std::random_device{}() & 0xFFFFu;
+
+    static constexpr char kHex[] = "0123456789abcdef";
+    char buf[24];
+    char* p = std::to_chars(buf, buf + 16, static_cast<std::uint64_t>(ms), 36).ptr;
+    for (int shift = 12; shift >= 0; shift -= 4) *p++ = kHex[(salt >> shift) & 0xF];
+    return std::string(buf, p);
+}
+
+// One tracked order, as lookup() copies it out.
+struct OrderRecord {
+    std::uint64_t client_seq = 0;       // client_order_id is "<id_prefix>-<client_seq>"
+    std::uint64_t ts_created = 0;       // TscClock ticks
+    std::uint64_t ts_updated = 0;
+    double qty = 0.0;
+    double filled_qty = 0.0;            // cumulative
+    double avg_price = 0.0;
+    double limit_price = 0.0;
+    SymbolId symbol = kNoSymbol;
+    Action side = Action::Buy;
+    OrderState state = OrderState::Free;
+    char order_id[40]{};                // Alpaca order UUID once known
+};
+
+// What apply() did to an order.
+struct OrderTransition {
+    OrderState from = OrderState::Free;
+    OrderState to = OrderState::Free;   // Free with from != Free: illegal event, order unchanged
+};
+
+// In-process order management: hands out client sequence numbers and the client_order_ids built
+// from them, keeps every open order in a preallocated pool and drives its state machine from
+// trade_updates.
+// Pool slots come from a free list and are found by client_seq through an open-addressed index
+// (linear probing, backward-shift deletion), so opening, looking up, transitioning and closing
+// never allocate. Terminal orders leave the pool immediately.
+// The order path (open / send failures) and the trade update thread both write; they serialize
+// on a SpinGuard held for a few stores.
+template <std::size_t MaxOpen = 4096>
+class OrderManager {
+
+    static_assert((MaxOpen & (MaxOpen - 1)) == 0, "MaxOpen must be a power of two");
+
+public:
+
+    struct Stats {
+        std::uint64_t opened = 0;
+        std::uint64_t closed = 0;
+        std::uint64_t updates = 0;
+        std::uint64_t untracked = 0;    // trade updates for orders we do not know (or no longer)
+        std::uint64_t illegal = 0;      // events not allowed from the order's state
+        std::uint64_t pool_full = 0;
+        std::size_t open = 0;
+    };
+
+    // Ids are "<iName>-<session tag>-<seq>"; seqs restart at 1 in every process, the tag does not
+    // repeat. Throws std::invalid_argument if the prefix would not fit an OrderSerializer, so a
+    // bad name fails here once rather than on every order.
+    explicit OrderManager(std::string_view iName = "ct")
+        : mIdPrefix(std::string(iName) + "-" + make_session_tag()),
+          mPool(std::make_unique<OrderRecord[]>(MaxOpen)),
+          mFree(std::make_unique<std::uint32_t[]>(MaxOpen)),
+          mIndex(std::make_unique<std::uint32_t[]>(kBuckets))
+    {
+        if (mIdPrefix.size() > OrderSerializer::kMaxClientIdPrefix) {
+            throw std::invalid_argument("OrderManager: name '" + std::string(iName) + "' makes the client_order_id prefix longer than "
+                + std::to_string(OrderSerializer::kMaxClientIdPrefix) + " characters");
+        }
+        for (const char c : iName) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                throw std::invalid_argument("OrderManager: invalid character in name");
+            }
+        }
+        for (std::size_t i = 0; i < MaxOpen; ++i) mFree[i] = static_cast<std::uint32_t>(MaxOpen - 1 - i);
+        mFreeCount = MaxOpen;
+        for (std::size_t b = 0; b < kBuckets; ++b) mIndex[b] = kEmpty;
+    }
+
+    OrderManager(const OrderManager&) = delete;
+    OrderManager& operator=(const OrderManager&) = delete;
+
+    // Next client sequence number (1, 2, ...), to be put in OrderMsg::seq.
+    std::uint64_t next_seq() noexcept { return mNextSeq.fetch_add(1, std::memory_order_relaxed); }
+
+    // "<name>-<session tag>", shared by every order of this process.
+    const std::string& id_prefix() const noexcept { return mIdPrefix; }
+
+    std::string client_order_id(std::uint64_t client_seq) const {
+        return mIdPrefix + "-" + std::to_string(client_seq);
+    }
+
+    // Start tracking an order about to be sent. False if the pool is full or the seq is in use.
+    bool open(const OrderMsg& m, double limit_price = 0.0) noexcept {
+        SpinGuard guard(mWriting);
+        if (m.seq == 0 || find_slot(m.seq) != kEmpty) return false;
+        if (mFreeCount == 0) {
+            ++mStats.pool_full;
+            return false;
+        }
+
+        const std::uint32_t slot = mFree[--mFreeCount];
+        OrderRecord& o = mPool[slot];
+        o = OrderRecord{};
+        o.client_seq = m.seq;
+        o.ts_created = o.ts_updated = m.ts_qpc;
+        o.qty = m.qty;
+        o.limit_price = limit_price;
+        o.symbol = m.symbol;
+        o.side = m.action;
+        o.state = OrderState::PendingNew;
+        insert(m.seq, slot);
+
+        ++mStats.opened;
+        ++mStats.open;
+        return true;
+    }
+
+    // Trade update from the stream (any order, ours or not).
+    OrderTransition apply(const TradeUpdateMsg& u) noexcept {
+        SpinGuard guard(mWriting);
+        ++mStats.updates;
+
+        const std::uint32_t slot = find_slot(u.client_seq);
+        if (slot == kEmpty) {
+            ++mStats.untracked;
+            return {};
+        }
+
+        OrderRecord& o = mPool[slot];
+        const OrderState next = next_order_state(o.state, u.event);
+        OrderTransition t{ o.state, next };
+        if (next == OrderState::Free) {
+            ++mStats.illegal;
+            return t;
+        }
+
+        o.state = next;
+        o.ts_updated = u.ts_recv;
+        if (o.order_id[0] == '\0') std::memcpy(o.order_id, u.order_id, sizeof(o.order_id));
+        if (u.event == TradeEvent::Fill || u.event == TradeEvent::PartialFill) {
+            o.filled_qty = u.cum_qty;
+            o.avg_price = u.avg_price;
+        }
+
+        if (is_terminal(next)) close(u.client_seq, slot);
+        return t;
+    }
+
+    // The POST never reached the broker or was refused (HTTP error); the order will not appear
+    // on trade_updates.
+    OrderTransition send_failed(std::uint64_t client_seq) noexcept {
+        SpinGuard guard(mWriting);
+        const std::uint32_t slot = find_slot(client_seq);
+        if (slot == kEmpty) return {};
+
+        OrderTransition t{ mPool[slot].state, OrderState::Rejected };
+        close(client_seq, slot);
+        return t;
+    }
+
+    // False once the order is terminal (or was never opened).
+    bool is_open(std::uint64_t client_seq) noexcept {
+        SpinGuard guard(mWriting);
+        return find_slot(client_seq) != kEmpty;
+    }
+
+    // Copy of an open order; false once it is terminal (or was never opened).
+    bool lookup(std::uint64_t client_seq, OrderRecord& out) noexcept {
+        SpinGuard guard(mWriting);
+        const std::uint32_t slot = find_slot(client_seq);
+        if (slot == kEmpty) return false;
+        out = mPool[slot];
+        return true;
+    }
+
+    Stats stats() noexcept {
+        SpinGuard guard(mWriting);
+        return mStats;
+    }
+
+private:
+
+    static constexpr std::size_t kBuckets = MaxOpen * 2;
+    static constexpr std::uint32_t kEmpty = std::numeric_limits<std::uint32_t>::max();
+
+    static std::size_t bucket_of(std::uint64_t client_seq) noexcept {
+        // Fibonacci hashing spreads consecutive sequence numbers.
+        return static_cast<std::size_t>((client_seq * 11400714819323198485ull) >> 32) & (kBuckets - 1);
+    }
+
+    std::uint32_t find_slot(std::uint64_t client_seq) const noexcept {
+        if (client_seq == 0) return kEmpty;
+        for (std::size_t b = bucket_of(client_seq);; b = (b + 1) & (kBuckets - 1)) {
+            const std::uint32_t slot = mIndex[b];
+            if (slot == kEmpty || mPool[slot].client_seq == client_seq) return slot;
+        }
+    }
+
+    void insert(std::uint64_t client_seq, std::uint32_t slot) noexcept {
+        std::size_t b = bucket_of(client_seq);
+        while (mIndex[b] != kEmpty) b = (b + 1) & (kBuckets - 1);
+        mIndex[b] = slot;
+    }
+
+    // Removes client_seq from the index (backward-shift, no tombstones) and frees its slot.
+    void close(std::uint64_t client_seq, std::uint32_t slot) noexcept {
+        std::size_t hole = bucket_of(client_seq);
+        while (mIndex[hole] != slot) hole = (hole + 1) & (kBuckets - 1);
+
+        for (std::size_t b = (hole + 1) & (kBuckets - 1); mIndex[b] != kEmpty; b = (b + 1) & (kBuckets - 1)) {
+            const std::size_t home = bucket_of(mPool[mIndex[b]].client_seq);
+            // Move b into the hole unless its home lies cyclically in (hole, b].
+            const bool stays = (hole < b) ? (home > hole && home <= b) : (home > hole || home <= b);
+            if (stays) continue;
+            mIndex[hole] = mIndex[b];
+            hole = b;
+        }
+        mIndex[hole] = kEmpty;
+
+        mPool[slot].state = OrderState::Free;
+        mPool[slot].client_seq = 0;
+        mFree[mFreeCount++] = slot;
+
+        ++mStats.closed;
+        --mStats.open;
+    }
+
+    std::string mIdPrefix;
+    std::unique_ptr<OrderRecord[]> mPool;
+    std::unique_ptr<std::uint32_t[]> mFree;
+    std::size_t mFreeCount = 0;
+    std::unique_ptr<std::uint32_t[]> mIndex;
+    std::atomic<std::uint64_t> mNextSeq{ 1 };
+    std::atomic_flag mWriting = ATOMIC_FLAG_INIT;
+    Stats mStats;
+};
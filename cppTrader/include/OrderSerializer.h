@@ -0,0 +1,148 @@
+#pragma once
+
+#include "common.h"
+#include "OrderType.h"
+#include <charconv>
+#include <stdexcept>
+
+// Writes a complete "POST /v2/orders" HTTP/1.1 request for an OrderMsg into a reusable buffer.
+// Request line, host and auth headers are written once in the constructor; per order only the
+// JSON body and the Content-Length digits are rewritten in place, with no allocation.
+class OrderSerializer {
+
+public:
+
+    static constexpr std::size_t kLengthDigits = 4;      // Content-Length is right-aligned in this field
+    static constexpr std::size_t kMaxClientIdPrefix = 32;
+    static constexpr std::size_t kMaxPriceChars = 24;    // shortest round-trip double, e.g. -1.7976931348623157e+308
+
+    // Longest body serialize_limit can write (serialize's is shorter): the fixed text plus the
+    // widest symbol, qty, client id and limit price.
+    static constexpr std::size_t kMaxBody =
+        (sizeof("{\"symbol\":\"") - 1) + SymbolTable::kMaxSymbolLength
+        + (sizeof("\",\"qty\":\"") - 1) + std::numeric_limits<std::uint32_t>::digits10 + 1
+        + (sizeof("\",\"side\":\"sell\",\"type\":\"") - 1) + (sizeof("market") - 1)
+        + (sizeof("\",\"time_in_force\":\"day\",\"client_order_id\":\"") - 1)
+        + kMaxClientIdPrefix + 1 + std::numeric_limits<std::uint64_t>::digits10 + 1 + 1
+        + (sizeof(",\"limit_price\":\"") - 1) + kMaxPriceChars + (sizeof("\"}") - 1);
+    static_assert(kMaxBody < 10'000, "Content-Length must fit in kLengthDigits");
+
+    OrderSerializer(std::string_view iHost, std::string_view iKeyId, std::string_view iSecret, std::string_view iClientIdPrefix = "ct",
+        const SymbolTable& iSymbols = SymbolTable::getInstance())
+        : mSymbols(iSymbols), mClientIdPrefix(iClientIdPrefix)
+    {
+        if (mClientIdPrefix.size() > kMaxClientIdPrefix) {
+            throw std::invalid_argument("OrderSerializer: client id prefix too long");
+        }
+        for (const char c : mClientIdPrefix) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                throw std::invalid_argument("OrderSerializer: invalid character in client id prefix");
+            }
+        }
+
+        std::string head;
+        head += "POST /v2/orders HTTP/1.1\r\n";
+        head += "Host: "; head += iHost; head += "\r\n";
+        head += "User-Agent: alpaca-rest-async/1.0\r\n";
+        head += "Accept: application/json\r\n";
+        head += "Content-Type: application/json\r\n";
+        head += "APCA-API-KEY-ID: "; head += iKeyId; head += "\r\n";
+        head += "APCA-API-SECRET-KEY: "; head += iSecret; head += "\r\n";
+        head += "Content-Length:";
+
+        mLengthAt = head.size();
+        mBodyAt = mLengthAt + kLengthDigits + 4;
+
+        mBuffer.resize(mBodyAt + kMaxBody);
+        std::memcpy(mBuffer.data(), head.data(), head.size());
+        std::memcpy(mBuffer.data() + mLengthAt + kLengthDigits, "\r\n\r\n", 4);
+    }
+
+    OrderSerializer(const OrderSerializer&) = delete;
+    OrderSerializer& operator=(const OrderSerializer&) = delete;
+
+    // Market order, time_in_force=day. The view stays valid until the next serialize call.
+    // Every write is checked against the body and throws std::length_error rather than overrun.
+    std::string_view serialize(const OrderMsg& m) {
+        char* p = write_common(m, "market");
+        p = put(p, "}");
+        return finish(p);
+    }
+
+    std::string_view serialize_limit(const OrderMsg& m, double iLimitPrice) {
+        char* p = write_common(m, "limit");
+        p = put(p, ",\"limit_price\":\"");
+        p = put_number(p, iLimitPrice);
+        p = put(p, "\"}");
+        return finish(p);
+    }
+
+    // Body of the last serialized request (for logging / tests).
+    std::string_view body() const { return { mBuffer.data() + mBodyAt, mBodyLen }; }
+
+private:
+
+    template <std::size_t N>
+    char* put(char* p, const char(&lit)[N]) {
+        return put(p, std::string_view(lit, N - 1));
+    }
+
+    char* put(char* p, std::string_view s) {
+        if (s.size() > static_cast<std::size_t>(body_end() - p)) overflow();
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+
+    template <class T>
+    char* put_number(char* p, T v) {
+        const auto r = std::to_chars(p, body_end(), v);
+        if (r.ec != std::errc{}) overflow();
+        return r.ptr;
+    }
+
+    [[noreturn]] static void overflow() {
+        throw std::length_error("OrderSerializer: body exceeds kMaxBody");
+    }
+
+    char* body_begin() noexcept { return mBuffer.data() + mBodyAt; }
+    char* body_end() noexcept { return mBuffer.data() + mBuffer.size(); }
+
+    // {"symbol":"AAPL","qty":"3","side":"buy","type":"market","time_in_force":"day","client_order_id":"ct-42"
+    template <std::size_t N>
+    char* write_common(const OrderMsg& m, const char(&iType)[N]) {
+        char* p = body_begin();
+        p = put(p, "{\"symbol\":\"");
+        p = put(p, mSymbols.name(m.symbol));
+        p = put(p, "\",\"qty\":\"");
+        p = put_number(p, m.qty);
+        p = (m.action == Action::Buy) ? put(p, "\",\"side\":\"buy\",\"type\":\"") : put(p, "\",\"side\":\"sell\",\"type\":\"");
+        p = put(p, iType);
+        p = put(p, "\",\"time_in_force\":\"day\",\"client_order_id\":\"");
+        p = put(p, mClientIdPrefix);
+        p = put(p, "-");
+        p = put_number(p, m.seq);
+        p = put(p, "\"");
+        return p;
+    }
+
+    std::string_view finish(char* p) noexcept {
+        mBodyLen = static_cast<std::size_t>(p - body_begin());
+
+        // "Content-Length:  123" - the leading spaces are optional whitespace per RFC 9110.
+        char* len = mBuffer.data() + mLengthAt;
+        std::memset(len, ' ', kLengthDigits);
+        char digits[kLengthDigits];
+        const auto r = std::to_chars(digits, digits + kLengthDigits, mBodyLen);
+        const std::size_t n = static_cast<std::size_t>(r.ptr - digits);
+        std::memcpy(len + kLengthDigits - n, digits, n);
+
+        return { mBuffer.data(), mBodyAt + mBodyLen };
+    }
+
+    const SymbolTable& mSymbols;
+    std::string mClientIdPrefix;
+    std::vector<char> mBuffer;
+    std::size_t mLengthAt = 0;
+    std::size_t mBodyAt = 0;
+    std::size_t mBodyLen = 0;
+};
@@ -1,16 +1,19 @@
+#pragma once
+
 #include "common.h"
 #include <nlohmann/json.hpp>
 #include "Benchmark.h"
+#include "SymbolTable.h"
 
 class BuyOrder {
     public:
-        BuyOrder(std::string iSymbol, int iQty, std::string iSide = "buy", std::string iType = "market", std::string iTime = "day")
+        BuyOrder(SymbolId iSymbol, int iQty, std::string iSide = "buy", std::string iType = "market", std::string iTime = "day")
             : mSymbol(iSymbol), mQty(iQty), mSide(iSide), mType(iType), mTime(iTime) { };
 
         nlohmann::json toJSON()
         {
             nlohmann::json j;
-            j["symbol"] = mSymbol;
+            j["symbol"] = SymbolTable::getInstance().name(mSymbol);
             j["qty"] = std::to_string(mQty);
             j["side"] = mSide;
             j["type"] = mType;
@@ -20,7 +23,7 @@ class BuyOrder {
         }
 private:
     
-        std::string mSymbol;
+        SymbolId mSymbol;
         int mQty;
         std::string mSide;
         std::string mType;
@@ -29,14 +32,14 @@ private:
 
 class SellOrder {
     public:
-        SellOrder(std::string iSymbol, int iQty, double iPriceLimit, std::string iSide = "sell", std::string iType = "limit", std::string iTime = "day")
+        SellOrder(SymbolId iSymbol, int iQty, double iPriceLimit, std::string iSide = "sell", std::string iType = "limit", std::string iTime = "day")
             : mSymbol(iSymbol), mQty(iQty), mPriceLimit(iPriceLimit), mSide(iSide), mType(iType), mTime(iTime) {
         };
 
         nlohmann::json toJSON()
         {
             nlohmann::json j;
-            j["symbol"] = mSymbol;
+            j["symbol"] = SymbolTable::getInstance().name(mSymbol);
             j["qty"] = std::to_string(mQty);
             j["side"] = mSide;
             j["type"] = mType;
@@ -47,7 +50,7 @@ class SellOrder {
         }
     private:
 
-        std::string mSymbol;
+        SymbolId mSymbol;
         int mQty;
         double mPriceLimit;
         std::string mSide;
@@ -55,24 +58,42 @@ class SellOrder {
         std::string mTime; 
 };
 
-static inline void copy_symbol(char(&dst)[16], std::string_view src) 
-{
-    // Copy up to 15 chars and always null-terminate.
-    const std::size_t n = std::min(src.size(), sizeof(dst) - 1);
-    std::memcpy(dst, src.data(), n);
-    dst[n] = '\0';
-}
-
 enum class Action : std::uint8_t { Buy = 1, Sell = 2 };
 
 #pragma pack(push, 1)
 struct OrderMsg {
-    std::uint64_t ts_qpc;      // producer timestamp (QPC ticks)
+    std::uint64_t ts_qpc;      // producer timestamp (TscClock ticks)
     std::uint64_t seq;         // sequence number
-    Action action;             // buy/sell
-    std::uint8_t _pad[3]{};    // padding
+    SymbolId symbol;           // SymbolTable::getInstance() id
     std::uint32_t qty;         // shares
-    char symbol[16];           // null-terminated
+    Action action;             // buy/sell
+    std::uint8_t _pad[7]{};    // padding
+};
+#pragma pack(pop)
+static_assert(sizeof(OrderMsg) == 32, "OrderMsg is half a cache line");
+
+enum class TradeEvent : std::uint8_t {
+    Unknown = 0, New, Fill, PartialFill, Canceled, Expired, Rejected, Replaced, DoneForDay, PendingNew, PendingCancel, PendingReplace
+};
+
+// Normalized trade_updates event as it travels through FastQueue (see TradeUpdatePipeline.h).
+#pragma pack(push, 1)
+struct TradeUpdateMsg {
+    std::uint64_t ts_recv;     // WebSocket frame received (QPC ticks)
+    std::uint64_t ts_decoded;  // update decoded (QPC ticks)
+    std::uint64_t ts_enqueued; // written into the queue (QPC ticks)
+    std::uint64_t client_seq;  // seq of our OrderMsg when client_order_id is "<prefix>-<seq>", else 0
+    double fill_qty;           // this execution (fill/partial_fill), else 0
+    double fill_price;         // this execution (fill/partial_fill), else 0
+    double cum_qty;            // order filled_qty
+    double avg_price;          // order filled_avg_price
+    double order_qty;          // order qty
+    double limit_price;        // order limit_price, 0 for market orders
+    TradeEvent event;
+    Action side;
+    std::uint8_t _pad[2]{};    // padding
+    SymbolId symbol;           // SymbolTable id, kNoSymbol when not interned
+    char order_id[40];         // Alpaca order UUID, null-terminated
 };
 #pragma pack(pop)
 
@@ -83,10 +104,11 @@ static inline OrderMsg make_msg(std::uint64_t seq, bool buy) {
     m.seq = seq;
     m.action = buy ? Action::Buy : Action::Sell;
     m.qty = 1 + (std::uint32_t)(seq % 10);
-    std::memset(m.symbol, 0, sizeof(m.symbol));
     // alternate symbols to avoid constant folding
-    const char* sym = (seq % 2 == 0) ? "AAPL" : "MSFT";
-    copy_symbol(m.symbol, sym);
+    static const std::array<SymbolId, 2> symbols = {
+        SymbolTable::getInstance().intern("AAPL"), SymbolTable::getInstance().intern("MSFT")
+    };
+    m.symbol = symbols[seq % 2];
     return m;
 }
 
@@ -95,6 +117,6 @@ static inline void print_msg(OrderMsg m)
     std::cout << "OrderMsg: seq=" << m.seq
         << " action=" << ((m.action == Action::Buy) ? "Buy" : "Sell")
         << " qty=" << m.qty
-        << " symbol=" << m.symbol
+        << " symbol=" << SymbolTable::getInstance().name(m.symbol)
         << "\n";
 }
\ No newline at end of file
@@ -5,9 +5,25 @@
 #include <boost/asio/steady_timer.hpp>
 #include <chrono>
 #include <iostream>
+#include <unordered_map>
 #include "myboost.h"
+#include "HttpsConnectionPool.h"
+#include "RestScheduler.h"
+#include "OrderSerializer.h"
+#include "LatencyTrace.h"
+#include "TradingState.h"
 #include "secrets_local.h"
 
+// Outcome of one order in a pipelined burst, matched back by client_order_id.
+struct OrderAck {
+	std::string client_order_id;
+	unsigned http_status = 0;          // 0 = no response (connection lost before the ack)
+	nlohmann::json body;
+	std::string error;
+
+	bool ok() const { return http_status == 200; }
+};
+
 class Portfolio {
 
 public:
@@ -17,20 +33,94 @@ public:
 		return instance;
 	}
 
-	asio::awaitable<void> poll_account_forever();
+	// Also trust this PEM certificate, e.g. MockAlpacaServer's self-signed one. Call before the
+	// first request.
+	void trust_certificate(std::string_view iPem);
+
+	// Open the keep-alive REST connections on the calling coroutine's executor (idempotent).
+	asio::awaitable<void> start_rest_pool(std::size_t iConnections = 2);
+
+	// Every REST call takes a token from rest_scheduler() first: cancels before orders before
+	// account polls, queued account refreshes coalesced. Defaults to Alpaca's 200 requests per
+	// minute; may be called before or after start_rest_pool.
+	void set_rest_rate_limit(const RestScheduler::Config& iConfig);
+
+	// Null until start_rest_pool.
+	const RestScheduler* rest_scheduler() const { return mRestScheduler.get(); }
+
+	// Account state is kept current from trade updates (apply_trade_update). These compare it
+	// with GET /v2/account over the pooled keep-alive connection, rebase on the broker's numbers
+	// and report the drift; the loop does so every iPeriod.
+	asio::awaitable<AccountDrift> reconcile_account();
+	asio::awaitable<void> reconcile_account_forever(std::chrono::seconds iPeriod = std::chrono::seconds(60));
+
+	// JSON order ({"symbol", "qty", "side", "type", ...}). Goes through risk() priced at its
+	// limit_price or the quotes() / mark reference price, and is rejected with std::runtime_error like the
+	// OrderMsg path. Without a client_order_id it gets the next OMS one and is tracked by
+	// orders(); a caller-named order is risk-checked but not tracked.
+	awaitable<nlohmann::json> alpaca_post_order( const nlohmann::json& order);
+
+	// Market order with the next OMS client sequence number, ready for alpaca_post_order.
+	OrderMsg make_order(SymbolId iSymbol, Action iSide, std::uint32_t iQty) noexcept { return mState.make_order(iSymbol, iSide, iQty, qpc_now()); }
+
+	// Hot path: market order serialized straight from the queue message, no JSON DOM.
+	// The order passes risk() first, priced from quotes() or the position's mark (with neither it
+	// is rejected for want of a reference price), and is rejected with
+	// std::runtime_error without touching the network if any limit is hit. Accepted orders are
+	// tracked by orders() under order.seq, which must be unique among open orders.
+	// With a tracer, the Serialized/Written/Acked stages of order.seq are stamped and completed.
+	awaitable<nlohmann::json> alpaca_post_order( const OrderMsg& order, LatencyTracer* iTracer = nullptr);
+
+	// Submit a burst of orders pipelined over every pooled connection, at most iWindow in flight
+	// per connection. Each order is admitted like alpaca_post_order(json); a rejected one is not
+	// sent and its ack carries the reason. Acks come back in input order.
+	awaitable<std::vector<OrderAck>> alpaca_post_orders(std::span<const nlohmann::json> orders, std::size_t iWindow = 16);
+
+	// DELETE /v2/orders/{id} for an open OMS order, at cancel priority. Throws if the order is
+	// not open or not yet acknowledged (no broker id). The order stays open until trade_updates
+	// reports it canceled.
+	awaitable<void> alpaca_cancel_order(std::uint64_t iClientSeq);
+
+	// Order, position and account engine (TradingState). Call from the one thread that drains
+	// trade updates.
+	bool apply_trade_update(const TradeUpdateMsg& iUpdate) noexcept { return mState.apply_trade_update(iUpdate); }
 
-	awaitable<nlohmann::json> alpaca_post_order( const nlohmann::json& order, ssl::context& tls_ctx);
+	void mark(SymbolId iSymbol, double iPrice) noexcept { mState.mark(iSymbol, iPrice); }
+
+	// Top of book that risk prices market orders from (TradingState::reference_price). Feed it
+	// from the stocks stream with a MarketDataPublisher on this cache; readable from any thread.
+	QuoteCache<>& quotes() noexcept { return mQuotes; }
+
+	// Lock-free from any thread; false when the symbol has no position record.
+	bool position(SymbolId iSymbol, Position& oPosition) const noexcept { return mState.position(iSymbol, oPosition); }
+
+	PositionTotals totals() const noexcept { return mState.totals(); }
+
+	// Lock-free from any thread. equity sums every position, so prefer buying_power() per order.
+	AccountSnapshot account() const noexcept { return mState.account(); }
+	double buying_power() const noexcept { return mState.buying_power(); }
+
+	// Pre-trade limits; set_limits/set_all_limits may be called from any thread at any time.
+	RiskGate<>& risk() noexcept { return mState.risk(); }
+
+	OrderManager<>& orders() noexcept { return mState.orders(); }
 
 	std::string getName() const { return mName; }
 
-	double getCash() const { return mCash; }
+	double getCash() const { return mState.cash(); }
 
 
 private:
 
 	Portfolio(const std::string& iName, const double& iCash, const std::string& iHost, const std::string& iPort);
 
-	awaitable<nlohmann::json> alpaca_get_account( ssl::context& tls_ctx);
+	awaitable<nlohmann::json> alpaca_get_account();
+	awaitable<nlohmann::json> fetch_account();
+
+	// Risk check and OMS admission of a JSON order; returns its OMS seq, 0 when caller-named.
+	std::uint64_t admit_order(nlohmann::json& ioOrder);
+
+	HttpsConnectionPool::Request make_rest_request(http::verb iVerb, beast::string_view iTarget) const;
 	
     
 	~Portfolio() = default;
@@ -38,8 +128,19 @@ private:
     Portfolio& operator=(const Portfolio&) = delete;
 
 	std::string mName;
-	double mCash;
 	std::string mHost;
 	std::string mPort;
 
+	ssl::context mTlsCtx;
+	std::unique_ptr<HttpsConnectionPool> mRestPool;
+	std::unique_ptr<RestScheduler> mRestScheduler;
+	RestScheduler::Config mRestLimit;
+	CoalescedRequest<nlohmann::json> mAccountRefresh;
+
+	// Free list: one serializer per concurrently pending order, reused once warmed up.
+	std::vector<std::unique_ptr<OrderSerializer>> mSerializers;
+
+	QuoteCache<> mQuotes;
+	TradingState mState;
+
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "common.h"
+#include "SeqLock.h"
+#include "SymbolTable.h"
+#include "OrderType.h"
+#include <cmath>
+#include <memory>
+
+// One symbol's position as a reader sees it. Quantities are signed: long > 0, short < 0.
+struct Position {
+    double qty = 0.0;
+    double avg_cost = 0.0;              // average entry price of the open quantity, 0 when flat
+    double realized = 0.0;              // P&L locked in by closing fills
+    double mark = 0.0;                  // last mark price (fill or market data)
+    double unrealized = 0.0;            // (mark - avg_cost) * qty
+    double exposure = 0.0;              // mark * qty
+    std::uint64_t fills = 0;
+    std::uint32_t version = 0;          // even; bumps by 2 per update
+
+    void derive() noexcept {
+        unrealized = (qty != 0.0) ? (mark - avg_cost) * qty : 0.0;
+        exposure = mark * qty;
+    }
+};
+
+// Portfolio-wide sums over every position.
+struct PositionTotals {
+    double realized = 0.0;
+    double unrealized = 0.0;
+    double net_exposure = 0.0;          // sum of signed exposure
+    double gross_exposure = 0.0;        // sum of |exposure|
+    std::size_t open_positions = 0;
+};
+
+// Positions maintained incrementally from fill events, one cache-line record per SymbolId.
+// Written by the single thread that drains trade updates, read by any thread through the same
+// seqlock protocol as QuoteCache, so a position query is a few loads instead of a REST call.
+// Fills use average-cost accounting: adding to a position moves the average, reducing it
+// realizes (price - avg_cost) per share closed, and crossing zero reopens at the fill price.
+template <std::size_t MaxSymbols = SymbolTable::kMaxSymbols>
+class PositionBook {
+
+    struct alignas(kCacheLine) Record {
+        std::atomic<std::uint32_t> seq{ 0 };
+        std::atomic<double> qty{ 0.0 };
+        std::atomic<double> avg_cost{ 0.0 };
+        std::atomic<double> realized{ 0.0 };
+        std::atomic<double> mark{ 0.0 };
+        std::atomic<std::uint64_t> fills{ 0 };
+    };
+    static_assert(sizeof(Record) == kCacheLine, "one record per cache line");
+
+public:
+
+    PositionBook()
+        : mRecords(std::make_unique<Record[]>(MaxSymbols)) { }
+
+    PositionBook(const PositionBook&) = delete;
+    PositionBook& operator=(const PositionBook&) = delete;
+
+    static constexpr std::size_t capacity() noexcept { return MaxSymbols; }
+
+    // False for kNoSymbol and for ids the book has no record for.
+    static constexpr bool contains(SymbolId id) noexcept { return id < MaxSymbols; }
+
+    // Writer side (one thread). Returns the P&L this fill realized.
+    double apply_fill(SymbolId id, Action side, double qty, double price) noexcept {
+        if (!(qty > 0.0)) return 0.0;
+
+        Record& r = mRecords[id];
+        const double pos = r.qty.load(std::memory_order_relaxed);
+        double avg = r.avg_cost.load(std::memory_order_relaxed);
+        const double delta = (side == Action::Buy) ? qty : -qty;
+        const double next = pos + delta;
+
+        double realized = 0.0;
+        if (pos == 0.0 || (pos > 0.0) == (delta > 0.0)) {
+            avg = (avg * std::abs(pos) + price * qty) / std::abs(next);
+        }
+        else {
+            const double closed = std::min(std::abs(delta), std::abs(pos));
+            realized = (price - avg) * (pos > 0.0 ? closed : -closed);
+            if (next == 0.0) avg = 0.0;
+            else if ((next > 0.0) != (pos > 0.0)) avg = price;
+        }
+
+        const double total_realized = r.realized.load(std::memory_order_relaxed) + realized;
+        const std::uint64_t fills = r.fills.load(std::memory_order_relaxed) + 1;
+        seqlock_write(r.seq, [&] {
+            r.qty.store(next, std::memory_order_relaxed);
+            r.avg_cost.store(avg, std::memory_order_relaxed);
+            r.realized.store(total_realized, std::memory_order_relaxed);
+            r.mark.store(price, std::memory_order_relaxed);
+            r.fills.store(fills, std::memory_order_relaxed);
+            });
+        return realized;
+    }
+
+    // Re-mark from market data (e.g. a QuoteCache mid) on the writer thread; only unrealized
+    // P&L and exposure move.
+    void mark(SymbolId id, double price) noexcept {
+        Record& r = mRecords[id];
+        seqlock_write(r.seq, [&] { r.mark.store(price, std::memory_order_relaxed); });
+    }
+
+    // Reader side (any thread). Returns the number of retries it took, for diagnostics.
+    std::uint32_t read(SymbolId id, Position& out) const noexcept {
+        const Record& r = mRecords[id];
+        const std::uint32_t retries = seqlock_read(r.seq, out.version, [&] {
+            out.qty = r.qty.load(std::memory_order_relaxed);
+            out.avg_cost = r.avg_cost.load(std::memory_order_relaxed);
+            out.realized = r.realized.load(std::memory_order_relaxed);
+            out.mark = r.mark.load(std::memory_order_relaxed);
+            out.fills = r.fills.load(std::memory_order_relaxed);
+            });
+        out.derive();
+        return retries;
+    }
+
+    // Sums over ids [0, symbols); each position is consistent on its own, not across symbols.
+    PositionTotals totals(std::size_t symbols) const noexcept {
+        PositionTotals t;
+        Position p;
+        for (std::size_t id = 0; id < std::min(symbols, MaxSymbols); ++id) {
+            read(static_cast<SymbolId>(id), p);
+            t.realized += p.realized;
+            t.unrealized += p.unrealized;
+            t.net_exposure += p.exposure;
+            t.gross_exposure += std::abs(p.exposure);
+            if (p.qty != 0.0) ++t.open_positions;
+        }
+        return t;
+    }
+
+private:
+
+    std::unique_ptr<Record[]> mRecords;
+};
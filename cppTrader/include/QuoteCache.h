@@ -0,0 +1,112 @@
+#pragma once
+
+#include "common.h"
+#include "SeqLock.h"
+#include "SymbolTable.h"
+#include <memory>
+
+// Latest top of book for one symbol, as a strategy sees it.
+struct Quote {
+    double bid_price = 0.0;
+    double ask_price = 0.0;
+    double last_price = 0.0;            // last trade
+    double bar_close = 0.0;             // last bar
+    std::uint32_t bid_size = 0;
+    std::uint32_t ask_size = 0;
+    std::uint32_t last_size = 0;
+    std::uint64_t bar_volume = 0;
+    std::uint64_t ts_recv = 0;          // TscClock ticks of the frame that last changed the record
+    std::uint32_t version = 0;          // even; bumps by 2 per update
+};
+
+// Fixed-capacity table of per-symbol top-of-book records, one cache line each, written by a
+// single market-data thread and read by any number of strategy threads.
+// Every record is a seqlock (SeqLock.h): a reader copies the fields and retries if the writer
+// was in the middle of an update.
+// Readers never block the writer or each other and nothing allocates after construction.
+// Records are indexed directly by SymbolId, so ids at or above MaxSymbols are not cached.
+template <std::size_t MaxSymbols = SymbolTable::kMaxSymbols>
+class QuoteCache {
+
+    struct alignas(kCacheLine) Record {
+        std::atomic<std::uint32_t> seq{ 0 };
+        std::atomic<std::uint32_t> bid_size{ 0 };
+        std::atomic<std::uint32_t> ask_size{ 0 };
+        std::atomic<std::uint32_t> last_size{ 0 };
+        std::atomic<double> bid_price{ 0.0 };
+        std::atomic<double> ask_price{ 0.0 };
+        std::atomic<double> last_price{ 0.0 };
+        std::atomic<double> bar_close{ 0.0 };
+        std::atomic<std::uint64_t> bar_volume{ 0 };
+        std::atomic<std::uint64_t> ts_recv{ 0 };
+    };
+    static_assert(sizeof(Record) == kCacheLine, "one record per cache line");
+
+public:
+
+    QuoteCache()
+        : mRecords(std::make_unique<Record[]>(MaxSymbols)) { }
+
+    QuoteCache(const QuoteCache&) = delete;
+    QuoteCache& operator=(const QuoteCache&) = delete;
+
+    static constexpr std::size_t capacity() noexcept { return MaxSymbols; }
+
+    // False for kNoSymbol and for ids the table has no record for.
+    static constexpr bool contains(SymbolId id) noexcept { return id < MaxSymbols; }
+
+    // Writer side (one thread).
+    void update_quote(SymbolId id, double bid, std::uint32_t bid_size, double ask, std::uint32_t ask_size, std::uint64_t ts_recv) noexcept {
+        Record& r = mRecords[id];
+        seqlock_write(r.seq, [&] {
+            r.bid_price.store(bid, std::memory_order_relaxed);
+            r.bid_size.store(bid_size, std::memory_order_relaxed);
+            r.ask_price.store(ask, std::memory_order_relaxed);
+            r.ask_size.store(ask_size, std::memory_order_relaxed);
+            r.ts_recv.store(ts_recv, std::memory_order_relaxed);
+            });
+    }
+
+    void update_trade(SymbolId id, double price, std::uint32_t size, std::uint64_t ts_recv) noexcept {
+        Record& r = mRecords[id];
+        seqlock_write(r.seq, [&] {
+            r.last_price.store(price, std::memory_order_relaxed);
+            r.last_size.store(size, std::memory_order_relaxed);
+            r.ts_recv.store(ts_recv, std::memory_order_relaxed);
+            });
+    }
+
+    void update_bar(SymbolId id, double close, std::uint64_t volume, std::uint64_t ts_recv) noexcept {
+        Record& r = mRecords[id];
+        seqlock_write(r.seq, [&] {
+            r.bar_close.store(close, std::memory_order_relaxed);
+            r.bar_volume.store(volume, std::memory_order_relaxed);
+            r.ts_recv.store(ts_recv, std::memory_order_relaxed);
+            });
+    }
+
+    // Reader side (any thread). Returns the number of retries it took, for diagnostics.
+    std::uint32_t read(SymbolId id, Quote& out) const noexcept {
+        const Record& r = mRecords[id];
+        return seqlock_read(r.seq, out.version, [&] {
+            out.bid_price = r.bid_price.load(std::memory_order_relaxed);
+            out.ask_price = r.ask_price.load(std::memory_order_relaxed);
+            out.last_price = r.last_price.load(std::memory_order_relaxed);
+            out.bar_close = r.bar_close.load(std::memory_order_relaxed);
+            out.bid_size = r.bid_size.load(std::memory_order_relaxed);
+            out.ask_size = r.ask_size.load(std::memory_order_relaxed);
+            out.last_size = r.last_size.load(std::memory_order_relaxed);
+            out.bar_volume = r.bar_volume.load(std::memory_order_relaxed);
+            out.ts_recv = r.ts_recv.load(std::memory_order_relaxed);
+            });
+    }
+
+    // Cheap change check: compare against Quote::version from the last read.
+    std::uint32_t version(SymbolId id) const noexcept {
+        return mRecords[id].seq.load(std::memory_order_acquire);
+    }
+
+private:
+
+    std::unique_ptr<Record[]> mRecords;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "common.h"
+#include "myboost.h"
+#include "HdrHistogram.hpp"
+#include <array>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+
+// Priority classes for outbound REST calls, highest first.
+enum class RestPriority : std::uint8_t {
+	Cancel = 0,         // DELETE /v2/orders/{id}: frees risk and buying power, never waits behind new orders
+	Order,              // POST /v2/orders
+	Account,            // GET /v2/account and other polls
+};
+
+inline constexpr std::size_t kRestPriorities = 3;
+
+static inline const char* rest_priority_name(RestPriority p) noexcept
+{
+	switch (p) {
+	case RestPriority::Cancel: return "cancel";
+	case RestPriority::Order: return "order";
+	default: return "account";
+	}
+}
+
+// Token bucket in front of the REST pool, sized to the broker's per-minute request budget.
+// A call that finds a token and nobody queued goes straight through (try_acquire, no suspension);
+// otherwise it queues in its priority class and is granted the next token once every higher
+// class is empty, so a burst of orders or polls cannot starve a cancel. One refill timer runs
+// only while something is queued.
+// Not thread safe: use from the executor it was created on, like HttpsConnectionPool.
+class RestScheduler {
+
+public:
+
+	struct Config {
+		double requests_per_minute = 200.0;              // Alpaca's default budget per account
+		double burst = 10.0;                             // tokens available after an idle period
+	};
+
+	struct ClassStats {
+		std::uint64_t granted = 0;
+		std::uint64_t immediate = 0;                     // granted without queueing
+		std::uint64_t coalesced = 0;                     // joined a queued identical request instead
+		std::size_t queued = 0;
+		std::size_t max_queued = 0;
+		HdrHistogram delay;                              // ns from acquire to grant, immediate ones included
+	};
+
+	RestScheduler(asio::any_io_executor iExecutor, Config iConfig);
+	RestScheduler(asio::any_io_executor iExecutor)
+		: RestScheduler(std::move(iExecutor), Config{}) { }
+
+	RestScheduler(const RestScheduler&) = delete;
+	RestScheduler& operator=(const RestScheduler&) = delete;
+
+	// New rate and depth; tokens already earned are kept (capped at the new burst).
+	void configure(Config iConfig);
+	const Config& config() const { return mConfig; }
+
+	// Takes a token if one is free and no request is queued.
+	bool try_acquire(RestPriority p);
+
+	// Completes once a token is granted to this request.
+	awaitable<void> acquire(RestPriority p);
+
+	// For CoalescedRequest: a caller was answered by another request of class p.
+	void note_coalesced(RestPriority p) { ++mStats[index(p)].coalesced; }
+
+	const ClassStats& stats(RestPriority p) const { return mStats[index(p)]; }
+	std::size_t queued() const { return mQueued; }
+	double tokens() const { return mTokens; }
+
+private:
+
+	struct Waiter {
+		asio::steady_timer wake;
+		std::chrono::steady_clock::time_point queued_at;
+		bool granted = false;
+	};
+
+	static std::size_t index(RestPriority p) { return static_cast<std::size_t>(p); }
+
+	void refill(std::chrono::steady_clock::time_point now);
+	void grant(RestPriority p, std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now);
+	void pump();
+	void arm_refill();
+	void withdraw(RestPriority p, Waiter& w);
+
+	asio::any_io_executor mExecutor;
+	Config mConfig;
+
+	double mTokens = 0.0;
+	double mTokensPerNs = 0.0;
+	std::chrono::steady_clock::time_point mLast;
+
+	std::array<std::deque<Waiter*>, kRestPriorities> mWaiters;
+	std::size_t mQueued = 0;
+	std::array<ClassStats, kRestPriorities> mStats;
+
+	asio::steady_timer mRefill;
+	bool mRefillArmed = false;
+	std::shared_ptr<bool> mAlive;                        // lets a late refill handler see the scheduler is gone
+};
+
+// Collapses identical idempotent reads (account refreshes) while one is queued for a token:
+// callers that arrive meanwhile wait for that request's answer instead of spending tokens of
+// their own. Once the token is granted the request is on its way and later callers start a new
+// one, so nobody gets data older than their call.
+template <class T>
+class CoalescedRequest {
+
+public:
+
+	template <class Fetch>
+	awaitable<T> run(RestScheduler& iScheduler, RestPriority iPriority, Fetch iFetch) {
+		if (mQueued) {
+			auto shared = mQueued;
+			iScheduler.note_coalesced(iPriority);
+			beast::error_code ec;
+			co_await shared->done.async_wait(asio::redirect_error(use_awaitable, ec));
+			if (shared->error) std::rethrow_exception(shared->error);
+			co_return *shared->value;
+		}
+
+		auto shared = std::make_shared<Shared>(co_await asio::this_coro::executor);
+		mQueued = shared;
+
+		try {
+			co_await iScheduler.acquire(iPriority);
+		}
+		catch (...) {
+			shared->error = std::current_exception();
+		}
+		mQueued.reset();
+
+		if (!shared->error) {
+			try {
+				shared->value.emplace(co_await iFetch());
+			}
+			catch (...) {
+				shared->error = std::current_exception();
+			}
+		}
+
+		shared->done.cancel();
+		if (shared->error) std::rethrow_exception(shared->error);
+		co_return *shared->value;
+	}
+
+private:
+
+	struct Shared {
+		explicit Shared(asio::any_io_executor ex) : done(ex, std::chrono::steady_clock::time_point::max()) { }
+		asio::steady_timer done;                         // cancelled when value or error is set
+		std::optional<T> value;
+		std::exception_ptr error;
+	};
+
+	std::shared_ptr<Shared> mQueued;                     // request still waiting for its token
+};
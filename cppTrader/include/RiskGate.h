@@ -0,0 +1,164 @@
+#pragma once
+
+#include "common.h"
+#include "SeqLock.h"
+#include "SymbolTable.h"
+#include "OrderType.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+// Per-symbol pre-trade limits.
+struct RiskLimits {
+    std::uint32_t max_qty = 10'000;             // shares per order
+    double max_notional = 1'000'000.0;          // qty * reference price per order
+    double orders_per_sec = 10'000.0;           // token bucket refill rate
+    double burst = 1'000.0;                     // token bucket depth
+    bool halted = false;                        // reject everything for this symbol
+};
+
+// Why an order was rejected; check() returns an OR of these, 0 = accepted.
+enum RiskReject : std::uint32_t {
+    RiskOk = 0,
+    RiskUnknownSymbol = 1u << 0,
+    RiskHalted = 1u << 1,
+    RiskMaxQty = 1u << 2,
+    RiskMaxNotional = 1u << 3,
+    RiskBuyingPower = 1u << 4,
+    RiskRate = 1u << 5,
+    RiskNoPrice = 1u << 6,              // no reference price: notional and buying power unknown
+};
+
+// First reason in a reject mask, for logs and error messages.
+static inline const char* risk_reject_reason(std::uint32_t mask) noexcept
+{
+    if (mask & RiskUnknownSymbol) return "unknown symbol";
+    if (mask & RiskHalted) return "symbol halted";
+    if (mask & RiskMaxQty) return "max qty";
+    if (mask & RiskNoPrice) return "no reference price";
+    if (mask & RiskMaxNotional) return "max notional";
+    if (mask & RiskBuyingPower) return "buying power";
+    if (mask & RiskRate) return "order rate";
+    return "ok";
+}
+
+// Pre-trade checks between an OrderMsg and the wire: max qty, max notional, buying power,
+// per-symbol order rate and a halt switch, against limits in a flat table indexed by SymbolId.
+// check() evaluates every rule into a bit mask instead of returning early, so the accepted path
+// is a handful of compares and selects with no allocation.
+// Limits are hot-reloadable: each symbol's limits are a seqlocked record (SeqLock.h), so
+// set_limits() from a control thread never pauses the checker, which at worst retries one read.
+// check() mutates the rate buckets and must stay on one thread (the one posting orders).
+template <std::size_t MaxSymbols = SymbolTable::kMaxSymbols>
+class RiskGate {
+
+    struct alignas(kCacheLine) Record {
+        std::atomic<std::uint32_t> seq{ 0 };
+        std::atomic<std::uint32_t> max_qty{ 0 };
+        std::atomic<std::uint32_t> halted{ 0 };
+        std::atomic<double> max_notional{ 0.0 };
+        std::atomic<double> tokens_per_tick{ 0.0 };
+        std::atomic<double> burst{ 0.0 };
+    };
+    static_assert(sizeof(Record) == kCacheLine, "one record per cache line");
+
+    // Checker-owned token bucket.
+    struct Bucket {
+        std::uint64_t last = 0;
+        double tokens = 0.0;
+    };
+
+public:
+
+    struct Stats {
+        std::uint64_t checked = 0;
+        std::uint64_t rejected = 0;
+    };
+
+    RiskGate(std::uint64_t iFreq, const RiskLimits& iDefaults = RiskLimits{})
+        : mFreq(iFreq),
+          mRecords(std::make_unique<Record[]>(MaxSymbols)),
+          mBuckets(std::make_unique<Bucket[]>(MaxSymbols))
+    {
+        set_all_limits(iDefaults);
+    }
+
+    RiskGate(const RiskGate&) = delete;
+    RiskGate& operator=(const RiskGate&) = delete;
+
+    static constexpr bool contains(SymbolId id) noexcept { return id < MaxSymbols; }
+
+    // Control side (any thread, rare). Takes effect on the next check of that symbol.
+    void set_limits(SymbolId id, const RiskLimits& limits) {
+        if (!contains(id)) return;
+        std::lock_guard<std::mutex> lock(mReloadMutex);
+        store(mRecords[id], limits);
+    }
+
+    void set_all_limits(const RiskLimits& limits) {
+        std::lock_guard<std::mutex> lock(mReloadMutex);
+        for (std::size_t id = 0; id < MaxSymbols; ++id) store(mRecords[id], limits);
+    }
+
+    // Order path. ref_price prices market orders (last mark / quote); without one (0, negative
+    // or NaN) the notional and buying-power rules cannot hold and the order is rejected. Consumes
+    // a rate token only when the order is accepted.
+    std::uint32_t check(const OrderMsg& m, double ref_price, double buying_power, std::uint64_t now) noexcept {
+        const bool known = contains(m.symbol);
+        const SymbolId id = known ? m.symbol : 0;
+
+        const Record& r = mRecords[id];
+        std::uint32_t max_qty = 0, halted = 0, version = 0;
+        double max_notional = 0.0, tokens_per_tick = 0.0, burst = 0.0;
+        seqlock_read(r.seq, version, [&] {
+            max_qty = r.max_qty.load(std::memory_order_relaxed);
+            halted = r.halted.load(std::memory_order_relaxed);
+            max_notional = r.max_notional.load(std::memory_order_relaxed);
+            tokens_per_tick = r.tokens_per_tick.load(std::memory_order_relaxed);
+            burst = r.burst.load(std::memory_order_relaxed);
+            });
+
+        Bucket& b = mBuckets[id];
+        const double tokens = std::min(burst, b.tokens + double(now - b.last) * tokens_per_tick);
+        const double notional = double(m.qty) * ref_price;
+        const bool buy = (m.action == Action::Buy);
+
+        std::uint32_t reject = 0;
+        reject |= std::uint32_t(!known) * RiskUnknownSymbol;
+        reject |= std::uint32_t(halted != 0) * RiskHalted;
+        reject |= std::uint32_t(m.qty > max_qty) * RiskMaxQty;
+        reject |= std::uint32_t(!(ref_price > 0.0)) * RiskNoPrice;
+        reject |= std::uint32_t(notional > max_notional) * RiskMaxNotional;
+        reject |= std::uint32_t(buy & (notional > buying_power)) * RiskBuyingPower;
+        reject |= std::uint32_t(tokens < 1.0) * RiskRate;
+
+        b.last = now;
+        b.tokens = tokens - double(reject == 0);
+
+        ++mStats.checked;
+        mStats.rejected += (reject != 0);
+        return reject;
+    }
+
+    const Stats& stats() const { return mStats; }
+
+private:
+
+    // Under mReloadMutex.
+    void store(Record& r, const RiskLimits& limits) noexcept {
+        const double tokens_per_tick = limits.orders_per_sec / double(mFreq);
+        seqlock_write(r.seq, [&] {
+            r.max_qty.store(limits.max_qty, std::memory_order_relaxed);
+            r.halted.store(limits.halted ? 1u : 0u, std::memory_order_relaxed);
+            r.max_notional.store(limits.max_notional, std::memory_order_relaxed);
+            r.tokens_per_tick.store(tokens_per_tick, std::memory_order_relaxed);
+            r.burst.store(limits.burst, std::memory_order_relaxed);
+            });
+    }
+
+    std::uint64_t mFreq;
+    std::unique_ptr<Record[]> mRecords;
+    std::unique_ptr<Bucket[]> mBuckets;
+    std::mutex mReloadMutex;
+    Stats mStats;
+};
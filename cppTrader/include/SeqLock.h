@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common.h"
+#include "FastQueue.hpp"
+
+// Seqlock protocol for single-writer records read by any number of threads (QuoteCache,
+// PositionBook). The record fields must be relaxed atomics so a torn read is a retry, not a
+// data race. The sequence is odd while a write is in progress and bumps by 2 per write.
+
+// Writer side: store() writes the fields.
+template <class F>
+inline void seqlock_write(std::atomic<std::uint32_t>& seq, F&& store) noexcept
+{
+    const std::uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    // Keeps the field stores below from becoming visible before the odd sequence.
+    std::atomic_thread_fence(std::memory_order_release);
+    store();
+    seq.store(s + 2, std::memory_order_release);
+}
+
+// Reader side: load() copies the fields out and may run several times. Returns the number of
+// retries it took; version gets the (even) sequence the copy is consistent with.
+template <class F>
+inline std::uint32_t seqlock_read(const std::atomic<std::uint32_t>& seq, std::uint32_t& version, F&& load) noexcept
+{
+    for (std::uint32_t retries = 0;; ++retries) {
+        const std::uint32_t s1 = seq.load(std::memory_order_acquire);
+        if (s1 & 1u) {
+            cpu_relax();
+            continue;
+        }
+
+        load();
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == s1) {
+            version = s1;
+            return retries;
+        }
+    }
+}
+
+// Mutual exclusion for the few structures with more than one writer (AccountState, OrderManager).
+// Holders only do a few stores, so waiters spin instead of sleeping.
+class SpinGuard {
+
+public:
+
+    explicit SpinGuard(std::atomic_flag& iFlag) noexcept : mFlag(iFlag) {
+        while (mFlag.test_and_set(std::memory_order_acquire)) cpu_relax();
+    }
+    ~SpinGuard() { mFlag.clear(std::memory_order_release); }
+
+    SpinGuard(const SpinGuard&) = delete;
+    SpinGuard& operator=(const SpinGuard&) = delete;
+
+private:
+
+    std::atomic_flag& mFlag;
+};
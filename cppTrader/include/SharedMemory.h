@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common.h"
+
+// Named shared-memory mapping, read/write, owned RAII-style and move-only.
+// POSIX: shm_open + mmap (an empty name gives an anonymous memfd that can be passed to a child
+// process). Windows: a pagefile-backed CreateFileMapping section.
+// Errors are reported with std::system_error.
+class SharedMemoryRegion {
+
+public:
+
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    SharedMemoryRegion(SharedMemoryRegion&& o) noexcept;
+    SharedMemoryRegion& operator=(SharedMemoryRegion&& o) noexcept;
+
+    // Creates (or truncates) the object and maps `bytes` of it, zero-filled. The creator removes
+    // the name again when the region is destroyed.
+    static SharedMemoryRegion create(const std::string& iName, std::size_t iBytes);
+
+    // Maps an existing object in full.
+    static SharedMemoryRegion open(const std::string& iName);
+
+    // Removes a name left behind by a crashed creator (no-op on Windows).
+    static void remove(const std::string& iName) noexcept;
+
+    std::byte* data() const noexcept { return mData; }
+    std::size_t size() const noexcept { return mSize; }
+    const std::string& name() const noexcept { return mName; }
+
+    // POSIX descriptor of the object (-1 on Windows); lets a memfd be inherited across fork/exec.
+    int native_fd() const noexcept { return mFd; }
+
+private:
+
+    void release() noexcept;
+
+    std::byte* mData = nullptr;
+    std::size_t mSize = 0;
+    std::string mName;
+    bool mOwner = false;
+    int mFd = -1;
+    void* mHandle = nullptr;    // Windows section handle
+};
+
+// File mapping for journals, owned RAII-style and move-only. create() preallocates the whole
+// file (so writes never hit a full disk or extend the file) and maps it read/write; open() maps
+// an existing file read-only. Errors are reported with std::system_error.
+class MappedFile {
+
+public:
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& o) noexcept;
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+    // Creates (or truncates) the file at `bytes`, zero-filled, with its pages faulted in.
+    static MappedFile create(const std::string& iPath, std::size_t iBytes);
+
+    // Maps an existing file in full, read-only.
+    static MappedFile open(const std::string& iPath);
+
+    // Starts writing dirty pages back without waiting for the disk.
+    void flush_async() noexcept;
+
+    std::byte* data() const noexcept { return mData; }
+    std::size_t size() const noexcept { return mSize; }
+    const std::string& path() const noexcept { return mPath; }
+
+private:
+
+    void release() noexcept;
+
+    std::byte* mData = nullptr;
+    std::size_t mSize = 0;
+    std::string mPath;
+    int mFd = -1;
+    void* mFile = nullptr;      // Windows file handle
+    void* mHandle = nullptr;    // Windows section handle
+};
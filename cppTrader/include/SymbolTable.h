@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common.h"
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+// Dense id of an interned ticker; ids are handed out 0, 1, 2, ... in intern order.
+using SymbolId = std::uint32_t;
+inline constexpr SymbolId kNoSymbol = std::numeric_limits<SymbolId>::max();
+
+// Ticker <-> dense id registry. Symbols are interned at startup (config, subscriptions) and
+// every message past the edge carries the 4-byte id instead of the text, so per-symbol tables
+// are plain arrays indexed by id and comparisons are integer compares.
+// find() and name() are lock-free and may run concurrently with intern(); intern() itself is
+// serialized and never moves existing entries. Ids are only meaningful inside one process
+// unless both sides intern the same symbols in the same order.
+class SymbolTable {
+
+public:
+
+    static constexpr std::size_t kMaxSymbols = 4096;
+    static constexpr std::size_t kMaxSymbolLength = 32;    // OrderSerializer sizes its body from this
+
+    static SymbolTable& getInstance() {
+        static SymbolTable instance;
+        return instance;
+    }
+
+    SymbolTable()
+        : mNames(std::make_unique<std::string[]>(kMaxSymbols)),
+          mBuckets(std::make_unique<std::atomic<SymbolId>[]>(kBuckets))
+    {
+        for (std::size_t b = 0; b < kBuckets; ++b) mBuckets[b].store(kNoSymbol, std::memory_order_relaxed);
+    }
+
+    explicit SymbolTable(const std::vector<std::string>& iSymbols)
+        : SymbolTable()
+    {
+        for (const auto& s : iSymbols) intern(s);
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Id of symbol, adding it if needed. Not for the hot path.
+    // Names go into order bodies without JSON escaping, so quotes, backslashes and control
+    // characters are rejected, as are names longer than kMaxSymbolLength.
+    SymbolId intern(std::string_view symbol) {
+        if (symbol.empty()) throw std::invalid_argument("SymbolTable: empty symbol");
+        if (symbol.size() > kMaxSymbolLength) throw std::invalid_argument("SymbolTable: symbol too long");
+        for (const char c : symbol) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                throw std::invalid_argument("SymbolTable: invalid character in symbol");
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mInternMutex);
+
+        std::size_t b = hash(symbol) & (kBuckets - 1);
+        for (;; b = (b + 1) & (kBuckets - 1)) {
+            const SymbolId id = mBuckets[b].load(std::memory_order_relaxed);
+            if (id == kNoSymbol) break;
+            if (mNames[id] == symbol) return id;
+        }
+
+        const SymbolId id = mSize.load(std::memory_order_relaxed);
+        if (id == kMaxSymbols) throw std::length_error("SymbolTable: too many symbols");
+
+        mNames[id].assign(symbol);
+        // The bucket publishes the name to find(); the size publishes it to name()/size().
+        mBuckets[b].store(id, std::memory_order_release);
+        mSize.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    // Id of symbol or kNoSymbol.
+    SymbolId find(std::string_view symbol) const noexcept {
+        for (std::size_t b = hash(symbol) & (kBuckets - 1);; b = (b + 1) & (kBuckets - 1)) {
+            const SymbolId id = mBuckets[b].load(std::memory_order_acquire);
+            if (id == kNoSymbol) return kNoSymbol;
+            if (mNames[id] == symbol) return id;
+        }
+    }
+
+    // Ticker of an id returned by intern()/find(); empty for kNoSymbol.
+    std::string_view name(SymbolId id) const noexcept {
+        if (id >= size()) return {};
+        return mNames[id];
+    }
+
+    std::size_t size() const noexcept { return mSize.load(std::memory_order_acquire); }
+
+private:
+
+    // At most half full, so probe sequences stay short.
+    static constexpr std::size_t kBuckets = kMaxSymbols * 2;
+
+    // FNV-1a; symbols are short.
+    static std::size_t hash(std::string_view s) noexcept {
+        std::uint32_t h = 2166136261u;
+        for (const char c : s) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        return h;
+    }
+
+    std::unique_ptr<std::string[]> mNames;
+    std::unique_ptr<std::atomic<SymbolId>[]> mBuckets;
+    std::atomic<SymbolId> mSize{ 0 };
+    std::mutex mInternMutex;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "JsonScan.h"
+
+// One Alpaca trade_updates message. Every field is a view into the frame bytes (no copies), so it
+// is only valid while the frame buffer is. Numbers are left as text; use as_double/as_u64.
+// String escapes are not decoded: ids, symbols and enums never contain any.
+struct TradeUpdateView {
+    std::string_view stream;            // "trade_updates" (or authorization/listening acks)
+    std::string_view event;             // new, fill, partial_fill, canceled, rejected, ...
+    std::string_view timestamp;
+    std::string_view price;             // this execution (fill/partial_fill only)
+    std::string_view qty;               // this execution (fill/partial_fill only)
+    std::string_view position_qty;
+
+    std::string_view order_id;
+    std::string_view client_order_id;
+    std::string_view symbol;
+    std::string_view side;
+    std::string_view status;
+    std::string_view filled_qty;        // cumulative
+    std::string_view filled_avg_price;
+    std::string_view order_qty;         // order quantity (the ack of a "new" event carries only this)
+    std::string_view limit_price;       // null for market orders
+};
+
+// Schema-aware, allocation-free decoder for trade_updates frames (text or binary JSON).
+// It walks the frame once, keeps the handful of fields above and skips everything else with an
+// SSE2 scan for string and container delimiters instead of building a DOM.
+class TradeUpdateDecoder : private JsonScan {
+
+public:
+
+    enum class Status : std::uint8_t { Ok, NotTradeUpdate, Malformed };
+
+    static Status decode(std::string_view frame, TradeUpdateView& out) noexcept {
+        out = {};
+        const char* end = frame.data() + frame.size();
+        const char* p = skip_ws(frame.data(), end);
+        if (p == end || *p != '{') return Status::Malformed;
+
+        if (!parse_object(p, end, Level::Root, out)) return Status::Malformed;
+        return (out.stream == "trade_updates") ? Status::Ok : Status::NotTradeUpdate;
+    }
+
+    // Frame holding either one message or an array of them; calls on_update for every trade
+    // update and returns how many there were. Stops at the first malformed element.
+    template <class F>
+    static std::size_t for_each(std::string_view frame, F&& on_update) {
+        const char* end = frame.data() + frame.size();
+        const char* p = skip_ws(frame.data(), end);
+        if (p == end) return 0;
+
+        TradeUpdateView v;
+        if (*p == '{') {
+            if (decode(frame, v) != Status::Ok) return 0;
+            on_update(v);
+            return 1;
+        }
+        if (*p != '[') return 0;
+
+        std::size_t n = 0;
+        p = skip_ws(p + 1, end);
+        while (p != end && *p == '{') {
+            v = {};
+            p = parse_object(p, end, Level::Root, v);
+            if (!p) break;
+            if (v.stream == "trade_updates") {
+                on_update(v);
+                ++n;
+            }
+            p = skip_ws(p, end);
+            if (p != end && *p == ',') p = skip_ws(p + 1, end);
+        }
+        return n;
+    }
+
+    using JsonScan::as_double;
+    using JsonScan::as_u64;
+
+private:
+
+    enum class Level : std::uint8_t { None, Root, Data, Order };
+
+    static std::string_view* field_slot(Level level, std::string_view key, TradeUpdateView& out) noexcept {
+        switch (level) {
+        case Level::Root:
+            if (key == "stream") return &out.stream;
+            break;
+        case Level::Data:
+            if (key == "event") return &out.event;
+            if (key == "price") return &out.price;
+            if (key == "qty") return &out.qty;
+            if (key == "timestamp") return &out.timestamp;
+            if (key == "position_qty") return &out.position_qty;
+            break;
+        case Level::Order:
+            if (key == "id") return &out.order_id;
+            if (key == "client_order_id") return &out.client_order_id;
+            if (key == "symbol") return &out.symbol;
+            if (key == "side") return &out.side;
+            if (key == "status") return &out.status;
+            if (key == "filled_qty") return &out.filled_qty;
+            if (key == "filled_avg_price") return &out.filled_avg_price;
+            if (key == "qty") return &out.order_qty;
+            if (key == "limit_price") return &out.limit_price;
+            break;
+        default:
+            break;
+        }
+        return nullptr;
+    }
+
+    static Level child_level(Level level, std::string_view key) noexcept {
+        if (level == Level::Root && key == "data") return Level::Data;
+        if (level == Level::Data && key == "order") return Level::Order;
+        return Level::None;
+    }
+
+    // p at '{'; returns one past the closing '}' or nullptr.
+    static const char* parse_object(const char* p, const char* end, Level level, TradeUpdateView& out) noexcept {
+        p = skip_ws(p + 1, end);
+        if (p != end && *p == '}') return p + 1;
+
+        for (;;) {
+            if (p == end || *p != '"') return nullptr;
+
+            std::string_view key;
+            p = read_string(p, end, key);
+            if (!p) return nullptr;
+
+            p = skip_ws(p, end);
+            if (p == end || *p != ':') return nullptr;
+            p = skip_ws(p + 1, end);
+            if (p == end) return nullptr;
+
+            const Level child = (*p == '{') ? child_level(level, key) : Level::None;
+            if (child != Level::None) {
+                p = parse_object(p, end, child, out);
+            }
+            else {
+                std::string_view value;
+                p = skip_value(p, end, value);
+                if (std::string_view* slot = field_slot(level, key, out)) *slot = value;
+            }
+            if (!p) return nullptr;
+
+            p = skip_ws(p, end);
+            if (p == end) return nullptr;
+            if (*p == '}') return p + 1;
+            if (*p != ',') return nullptr;
+            p = skip_ws(p + 1, end);
+        }
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "common.h"
+#include "Benchmark.h"
+#include "FastQueue.hpp"
+#include "OrderType.h"
+#include "TradeUpdateDecoder.h"
+#include <charconv>
+#include <span>
+
+// WebSocket reader -> TradeUpdateMsg -> FastQueue -> strategy/portfolio threads.
+// The network thread only decodes and copies a fixed-layout struct; consumers never see JSON.
+
+using TradeUpdateQueue = FastQueue<(1u << 16), 8, (1u << 12)>;
+
+template <std::size_t N>
+static inline void copy_cstr(char(&dst)[N], std::string_view src)
+{
+    // Copy up to N-1 chars and always null-terminate.
+    const std::size_t n = std::min(src.size(), N - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+static inline TradeEvent parse_trade_event(std::string_view e)
+{
+    if (e == "fill") return TradeEvent::Fill;
+    if (e == "partial_fill") return TradeEvent::PartialFill;
+    if (e == "new") return TradeEvent::New;
+    if (e == "canceled") return TradeEvent::Canceled;
+    if (e == "rejected") return TradeEvent::Rejected;
+    if (e == "expired") return TradeEvent::Expired;
+    if (e == "replaced") return TradeEvent::Replaced;
+    if (e == "done_for_day") return TradeEvent::DoneForDay;
+    if (e == "pending_new") return TradeEvent::PendingNew;
+    if (e == "pending_cancel") return TradeEvent::PendingCancel;
+    if (e == "pending_replace") return TradeEvent::PendingReplace;
+    return TradeEvent::Unknown;
+}
+
+// "<prefix>-<seq>" -> seq for our own orders, prefix being OrderManager::id_prefix(). Anything
+// else (other portfolios, manual orders, earlier sessions, an empty prefix) gives 0.
+static inline std::uint64_t parse_client_seq(std::string_view client_order_id, std::string_view prefix)
+{
+    if (prefix.empty() || client_order_id.size() <= prefix.size() + 1) return 0;
+    if (!client_order_id.starts_with(prefix) || client_order_id[prefix.size()] != '-') return 0;
+
+    const std::string_view digits = client_order_id.substr(prefix.size() + 1);
+    std::uint64_t seq = 0;
+    const auto r = std::from_chars(digits.data(), digits.data() + digits.size(), seq);
+    return (r.ec == std::errc{} && r.ptr == digits.data() + digits.size()) ? seq : 0;
+}
+
+static inline void normalize_trade_update(const TradeUpdateView& v, std::uint64_t ts_recv, const SymbolTable& symbols,
+    std::string_view client_id_prefix, TradeUpdateMsg& m)
+{
+    m = TradeUpdateMsg{};
+    m.ts_recv = ts_recv;
+    m.client_seq = parse_client_seq(v.client_order_id, client_id_prefix);
+    m.fill_qty = TradeUpdateDecoder::as_double(v.qty);
+    m.fill_price = TradeUpdateDecoder::as_double(v.price);
+    m.cum_qty = TradeUpdateDecoder::as_double(v.filled_qty);
+    m.avg_price = TradeUpdateDecoder::as_double(v.filled_avg_price);
+    m.order_qty = TradeUpdateDecoder::as_double(v.order_qty);
+    m.limit_price = TradeUpdateDecoder::as_double(v.limit_price);
+    m.event = parse_trade_event(v.event);
+    m.side = (v.side == "sell") ? Action::Sell : Action::Buy;
+    m.symbol = symbols.find(v.symbol);
+    copy_cstr(m.order_id, v.order_id);
+}
+
+// Network-thread side counters (ns). Written only by the reader coroutine.
+struct TradeUpdatePublisherStats {
+    HdrHistogram decode;       // frame received -> update decoded
+    HdrHistogram enqueue;      // decoded -> committed to the queue
+    std::uint64_t frames = 0;
+    std::uint64_t updates = 0;
+    std::uint64_t other_frames = 0;  // acks / anything that was not a trade update
+};
+
+// Consumer-thread side counters (ns). Written only by the consumer.
+struct TradeUpdateConsumerStats {
+    HdrHistogram queue;        // committed -> dequeued
+    HdrHistogram end_to_end;   // frame received -> dequeued
+    std::uint64_t consumed = 0;
+};
+
+template <class Producer>
+class TradeUpdatePublisher {
+
+public:
+
+    // Updates get a client_seq only when their client_order_id is under iClientIdPrefix (the
+    // Portfolio's orders().id_prefix()); with an empty prefix every client_seq is 0.
+    TradeUpdatePublisher(Producer iProducer, std::uint64_t iFreq, std::string iClientIdPrefix = {},
+        const SymbolTable& iSymbols = SymbolTable::getInstance())
+        : mProducer(std::move(iProducer)), mFreq(iFreq), mClientIdPrefix(std::move(iClientIdPrefix)), mSymbols(iSymbols) { }
+
+    // Decode every trade update in the frame and enqueue it. Returns 0 for control frames,
+    // which the caller handles itself.
+    std::size_t publish_frame(std::string_view frame, std::uint64_t ts_recv)
+    {
+        ++mStats.frames;
+
+        const std::size_t n = TradeUpdateDecoder::for_each(frame, [&](const TradeUpdateView& v) {
+            const std::uint64_t ts_decoded = qpc_now();
+
+            mProducer.write_with(sizeof(TradeUpdateMsg), [&](std::span<std::byte> dst) {
+                TradeUpdateMsg m;
+                normalize_trade_update(v, ts_recv, mSymbols, mClientIdPrefix, m);
+                m.ts_decoded = ts_decoded;
+                m.ts_enqueued = qpc_now();
+                std::memcpy(dst.data(), &m, sizeof(m));
+                });
+
+            const std::uint64_t ts_done = qpc_now();
+            mStats.decode.add(ticks_to_ns(ts_decoded - ts_recv, mFreq));
+            mStats.enqueue.add(ticks_to_ns(ts_done - ts_decoded, mFreq));
+            });
+
+        mStats.updates += n;
+        if (n == 0) ++mStats.other_frames;
+        return n;
+    }
+
+    const TradeUpdatePublisherStats& stats() const { return mStats; }
+
+private:
+
+    Producer mProducer;
+    std::uint64_t mFreq;
+    std::string mClientIdPrefix;
+    const SymbolTable& mSymbols;
+    TradeUpdatePublisherStats mStats;
+};
+
+template <class Consumer>
+class TradeUpdateSubscriber {
+
+public:
+
+    TradeUpdateSubscriber(Consumer iConsumer, std::uint64_t iFreq)
+        : mConsumer(std::move(iConsumer)), mFreq(iFreq) { }
+
+    // Hands every queued update to on_update (read in place, one copy into the struct) and
+    // returns how many there were; 0 when the queue is empty.
+    template <class F>
+    std::size_t drain(F&& on_update, std::size_t max_updates = std::numeric_limits<std::size_t>::max())
+    {
+        return mConsumer.read_batch([&](std::span<const std::byte> frame) {
+            if (frame.size() != sizeof(TradeUpdateMsg)) return;
+
+            TradeUpdateMsg m;
+            std::memcpy(&m, frame.data(), sizeof(m));
+
+            const std::uint64_t now = qpc_now();
+            mStats.queue.add(ticks_to_ns(now >= m.ts_enqueued ? now - m.ts_enqueued : 0, mFreq));
+            mStats.end_to_end.add(ticks_to_ns(now >= m.ts_recv ? now - m.ts_recv : 0, mFreq));
+            ++mStats.consumed;
+
+            on_update(m);
+            }, max_updates);
+    }
+
+    const TradeUpdateConsumerStats& stats() const { return mStats; }
+
+private:
+
+    Consumer mConsumer;
+    std::uint64_t mFreq;
+    TradeUpdateConsumerStats mStats;
+};
+
+static inline void print_stage(const char* name, const HdrHistogram& h)
+{
+    std::cout << "  " << name << " n=" << h.total
+        << " p50=" << h.percentile(0.50)
+        << " p99=" << h.percentile(0.99)
+        << " max=" << h.max_value() << " ns\n";
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "common.h"
+#include "OrderType.h"
+#include "PositionBook.h"
+#include "AccountState.h"
+#include "RiskGate.h"
+#include "OrderManager.h"
+#include "QuoteCache.h"
+
+// Everything a Portfolio keeps locally about its orders, positions, account and limits, without
+// the REST side: Portfolio owns one for live trading and every backtest owns its own.
+// Timestamps are in the units of iFreq (TscClock ticks live, simulated ns in a backtest).
+// apply_trade_update / mark run on the one thread that drains trade updates; the readers are
+// lock-free from any thread.
+class TradingState {
+
+    // An interned id without a position or risk record would move cash but no position.
+    static_assert(PositionBook<>::capacity() >= SymbolTable::kMaxSymbols, "PositionBook must hold every interned symbol");
+    static_assert(RiskGate<>::contains(SymbolTable::kMaxSymbols - 1), "RiskGate must hold every interned symbol");
+
+public:
+
+    // iName starts the OMS client_order_ids (see OrderManager::id_prefix). iQuotes, when given,
+    // prices market orders that have no mark yet (see reference_price).
+    TradingState(double iCash, std::uint64_t iFreq, std::string_view iName = "ct", const QuoteCache<>* iQuotes = nullptr)
+        : mAccount(iCash), mRisk(iFreq), mOrders(iName), mQuotes(iQuotes) { }
+
+    TradingState(const TradingState&) = delete;
+    TradingState& operator=(const TradingState&) = delete;
+
+    // Market order with the next OMS client sequence number.
+    OrderMsg make_order(SymbolId iSymbol, Action iSide, std::uint32_t iQty, std::uint64_t iNow) noexcept;
+
+    // Pre-trade check against current buying power, priced at iLimitPrice when given, else at
+    // reference_price (RiskNoPrice when there is none). 0 or a RiskReject mask.
+    std::uint32_t risk_check(const OrderMsg& iOrder, std::uint64_t iNow, double iLimitPrice = 0.0) noexcept;
+
+    // Every event advances the order's OMS state, "new" reserves buying power, fills move
+    // positions, cash and buying power, and cancel / expire / reject / replaced / done_for_day
+    // release the reservation. Returns false for events it ignores.
+    bool apply_trade_update(const TradeUpdateMsg& iUpdate) noexcept;
+
+    // Rebase the account on the broker's cash and buying power; reservations of orders the OMS
+    // no longer has open are dropped (see AccountState::reconcile).
+    AccountDrift reconcile_account(double iCash, double iBuyingPower) noexcept;
+
+    void mark(SymbolId iSymbol, double iPrice) noexcept;
+
+    // Price a market order is checked and held at: the quote mid, else the last trade from the
+    // QuoteCache, else the position's mark, else 0.
+    double reference_price(SymbolId iSymbol) const noexcept;
+
+    // False when the symbol has no position record.
+    bool position(SymbolId iSymbol, Position& oPosition) const noexcept;
+
+    PositionTotals totals() const noexcept;
+
+    // equity sums every position, so prefer buying_power() per order.
+    AccountSnapshot account() const noexcept;
+    double buying_power() const noexcept { return mAccount.buying_power(); }
+    double cash() const noexcept { return mAccount.cash(); }
+
+    AccountState& account_state() noexcept { return mAccount; }
+    RiskGate<>& risk() noexcept { return mRisk; }
+    OrderManager<>& orders() noexcept { return mOrders; }
+
+private:
+
+    PositionBook<> mPositions;
+    AccountState mAccount;
+    RiskGate<> mRisk;
+    OrderManager<> mOrders;
+    const QuoteCache<>* mQuotes;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common.h"
+#include "FastQueue.hpp"
+#include <thread>
+
+// What a consumer does when its queue is empty. Cheaper wake-up costs more CPU:
+//   BusySpin  : pause in a loop, never gives up the core (lowest latency, one core at 100%)
+//   SpinYield : spin for a while, then yield the time slice between polls
+//   SpinBlock : spin for a while, then sleep on a futex (WaitOnAddress on Windows) until the
+//               producer rings the QueueDoorbell
+//   AsioTimer : co_await a steady_timer of BenchConfig::empty_backoff (the original behaviour)
+enum class WaitMode : std::uint8_t { BusySpin, SpinYield, SpinBlock, AsioTimer };
+
+static inline const char* to_string(WaitMode m)
+{
+    switch (m) {
+    case WaitMode::BusySpin: return "spin";
+    case WaitMode::SpinYield: return "yield";
+    case WaitMode::SpinBlock: return "block";
+    case WaitMode::AsioTimer: return "timer";
+    }
+    return "?";
+}
+
+static inline bool parse_wait_mode(std::string_view s, WaitMode& out)
+{
+    for (const WaitMode m : { WaitMode::BusySpin, WaitMode::SpinYield, WaitMode::SpinBlock, WaitMode::AsioTimer }) {
+        if (s == to_string(m)) {
+            out = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Producer -> sleeping consumer wake-up. The producer only pays a relaxed load of a flag that
+// nobody writes while the consumer is awake; the atomic notify happens only when a consumer
+// has actually gone to sleep.
+class QueueDoorbell {
+
+    // 32-bit words so wait/notify map straight onto a futex instead of the library's proxy table.
+    struct alignas(kCacheLine) PaddedWord {
+        std::atomic<std::uint32_t> v{ 0 };
+    };
+
+public:
+
+    // Producer side, after the frame is committed.
+    void notify() noexcept {
+        // Pairs with the fence in wait(): either we see the sleeper, or it sees our commit.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mSleeping.v.load(std::memory_order_relaxed) != 0) {
+            mEpoch.v.fetch_add(1, std::memory_order_release);
+            mEpoch.v.notify_one();
+        }
+    }
+
+    // Consumer side: sleeps until notify() unless ready() turns true after announcing itself.
+    template <class Ready>
+    void wait(Ready&& ready) noexcept {
+        const std::uint32_t epoch = mEpoch.v.load(std::memory_order_acquire);
+
+        mSleeping.v.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!ready()) {
+            mEpoch.v.wait(epoch, std::memory_order_acquire);
+        }
+        mSleeping.v.store(0, std::memory_order_relaxed);
+    }
+
+private:
+
+    PaddedWord mSleeping;
+    PaddedWord mEpoch;
+};
+
+// Consumer-side policy for the synchronous modes; AsioTimer is handled by the caller because it
+// has to co_await. Call idle() on every empty poll and reset() whenever data arrived.
+class ConsumerWaiter {
+
+public:
+
+    ConsumerWaiter(WaitMode iMode, std::uint32_t iSpinLimit, QueueDoorbell* iDoorbell = nullptr)
+        : mMode(iMode), mSpinLimit(iSpinLimit), mDoorbell(iDoorbell) { }
+
+    template <class Ready>
+    void idle(Ready&& ready) noexcept {
+        if (mMode == WaitMode::BusySpin || mIdle < mSpinLimit) {
+            ++mIdle;
+            cpu_relax();
+            return;
+        }
+
+        if (mMode == WaitMode::SpinBlock && mDoorbell) {
+            ++mBlocks;
+            mDoorbell->wait(std::forward<Ready>(ready));
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+
+    void reset() noexcept { mIdle = 0; }
+
+    WaitMode mode() const noexcept { return mMode; }
+    std::uint64_t blocks() const noexcept { return mBlocks; }
+
+private:
+
+    WaitMode mMode;
+    std::uint32_t mSpinLimit;
+    QueueDoorbell* mDoorbell;
+    std::uint32_t mIdle = 0;
+    std::uint64_t mBlocks = 0;
+};
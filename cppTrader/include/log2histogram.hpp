@@ -1,4 +1,5 @@
 #include "common.h"
+#include <bit>
 
 struct Log2Histogram {
     static constexpr int BINS = 64;
@@ -8,9 +9,7 @@ struct Log2Histogram {
     static int bin_index(std::uint64_t ns) {
         if (ns == 0) return 0;
 
-        unsigned long idx;
-        _BitScanReverse64(&idx, ns);
-        int i = (int)idx;
+        int i = std::bit_width(ns) - 1;
         return (i < BINS - 1) ? i : (BINS - 1);
     }
 
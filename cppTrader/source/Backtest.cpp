@@ -0,0 +1,173 @@
+#include "Backtest.h"
+
+#include <algorithm>
+#include <cstdio>
+
+
+BacktestEngine::BacktestEngine(const BacktestConfig& iConfig)
+    : mConfig(iConfig), mState(iConfig.cash, SimClock::kFrequency, "bt"),
+      mOrderOut(mOrderQueue.make_producer()), mOrderIn(mOrderQueue.make_consumer()),
+      mRandom(iConfig.fills.seed)
+{
+    mState.risk().set_all_limits(mConfig.limits);
+    mPeakEquity = mConfig.cash;
+    mConfig.equity_sample = std::max<std::uint32_t>(mConfig.equity_sample, 1);
+}
+
+// splitmix64: the same stream on every platform, unlike the std distributions.
+std::uint64_t BacktestEngine::next_random() noexcept
+{
+    std::uint64_t z = (mRandom += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool BacktestEngine::quote(SymbolId iSymbol, Quote& oQuote) const noexcept
+{
+    if (!QuoteCache<>::contains(iSymbol)) return false;
+    mQuotes.read(iSymbol, oQuote);
+    return true;
+}
+
+void BacktestEngine::on_market(const MarketEvent& e) noexcept
+{
+    if (mResult.events++ == 0) mFirstTs = e.ts;
+    mClock.advance_to(e.ts);
+
+    if (QuoteCache<>::contains(e.symbol)) {
+        switch (e.type) {
+        case MarketDataType::Quote:
+            mQuotes.update_quote(e.symbol, e.bid, 0, e.ask, 0, e.ts);
+            if (e.bid > 0.0 && e.ask > 0.0) mState.mark(e.symbol, 0.5 * (e.bid + e.ask));
+            break;
+        case MarketDataType::Trade:
+            mQuotes.update_trade(e.symbol, e.price, e.size, e.ts);
+            mState.mark(e.symbol, e.price);
+            break;
+        case MarketDataType::Bar:
+            mQuotes.update_bar(e.symbol, e.price, e.size, e.ts);
+            mState.mark(e.symbol, e.price);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (mResult.events % mConfig.equity_sample == 0) sample_equity();
+}
+
+std::uint64_t BacktestEngine::submit(SymbolId iSymbol, Action iSide, std::uint32_t iQty)
+{
+    const OrderMsg m = mState.make_order(iSymbol, iSide, iQty, mClock.now());
+    const auto bytes = std::as_bytes(std::span{ &m, 1 });
+
+    // One thread both ends: make room by sending what is queued instead of waiting.
+    if (!mOrderOut.try_write(bytes)) {
+        send_orders();
+        mOrderOut.write(bytes);
+    }
+    ++mResult.orders;
+    return m.seq;
+}
+
+void BacktestEngine::send_orders()
+{
+    mOrderIn.read_batch([&](std::span<const std::byte> frame) {
+        OrderMsg m;
+        std::memcpy(&m, frame.data(), sizeof(m));
+        simulate_post(m);
+        });
+}
+
+// Stands in for alpaca_post_order: same risk check and OMS admission, then the broker's answer
+// is scheduled on the simulated clock.
+void BacktestEngine::simulate_post(const OrderMsg& m)
+{
+    TradeUpdateMsg u{};
+    u.client_seq = m.seq;
+    u.order_qty = m.qty;
+    u.side = m.action;
+    u.symbol = m.symbol;
+    std::snprintf(u.order_id, sizeof(u.order_id), "bt-%llu", static_cast<unsigned long long>(m.seq));
+
+    const std::uint64_t now = mClock.now();
+    if (mState.risk_check(m, now) != 0 || !mState.orders().open(m)) {
+        // Live, the POST throws before reaching the broker; here the strategy hears it as a reject.
+        ++mResult.risk_rejects;
+        u.event = TradeEvent::Rejected;
+        schedule(now, u);
+        return;
+    }
+
+    const FillModel& f = mConfig.fills;
+    const std::uint64_t ack = now + f.ack_ns + (f.jitter_ns ? next_random() % f.jitter_ns : 0);
+
+    u.event = TradeEvent::New;
+    schedule(ack, u);
+    u.event = TradeEvent::Fill;
+    schedule(ack + f.fill_ns, u);
+}
+
+void BacktestEngine::schedule(std::uint64_t due, const TradeUpdateMsg& u)
+{
+    mPending.push(Pending{ due, mPendingOrder++, u });
+}
+
+TradeUpdateMsg BacktestEngine::deliver_next() noexcept
+{
+    TradeUpdateMsg u = mPending.top().update;
+    mClock.advance_to(mPending.top().due);
+    mPending.pop();
+    u.ts_recv = u.ts_decoded = u.ts_enqueued = mClock.now();
+
+    if (u.event == TradeEvent::Fill) {
+        // Cross the book as it is now; fall back to the last trade or bar.
+        Quote q;
+        double price = 0.0;
+        if (quote(u.symbol, q)) {
+            price = (u.side == Action::Buy) ? q.ask_price : q.bid_price;
+            if (price <= 0.0) price = (q.last_price > 0.0) ? q.last_price : q.bar_close;
+        }
+
+        if (price > 0.0) {
+            const double slip = mConfig.fills.slippage_bps * 1e-4;
+            price *= (u.side == Action::Buy) ? (1.0 + slip) : (1.0 - slip);
+            u.fill_qty = u.cum_qty = u.order_qty;
+            u.fill_price = u.avg_price = price;
+            ++mResult.fills;
+        }
+        else {
+            u.event = TradeEvent::Rejected;
+            ++mResult.rejected;
+        }
+    }
+
+    mState.apply_trade_update(u);
+    if (u.event == TradeEvent::Fill) sample_equity();
+    return u;
+}
+
+void BacktestEngine::sample_equity() noexcept
+{
+    const double equity = mState.account().equity;
+    mPeakEquity = std::max(mPeakEquity, equity);
+    mResult.max_drawdown = std::max(mResult.max_drawdown, mPeakEquity - equity);
+}
+
+BacktestResult BacktestEngine::finish(double iWallSeconds) noexcept
+{
+    sample_equity();
+
+    const AccountSnapshot a = mState.account();
+    const PositionTotals t = mState.totals();
+
+    BacktestResult r = mResult;
+    r.cash = a.cash;
+    r.equity = a.equity;
+    r.realized = t.realized;
+    r.unrealized = t.unrealized;
+    r.sim_seconds = double(mClock.now() - mFirstTs) / double(SimClock::kFrequency);
+    r.wall_seconds = iWallSeconds;
+    return r;
+}
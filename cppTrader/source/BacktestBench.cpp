@@ -0,0 +1,186 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "Backtest.h"
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+// BacktestEngine on a synthetic random-walk tape (kBtSymbols symbols, one quote every kBtGap of
+// simulated time, a trade every tenth event) with an EMA crossover strategy:
+//   1. one run: events/s and how much faster than real time it is on one core;
+//   2. the same run again must give bit-identical results;
+//   3. a parameter sweep on every core and on one core must give identical results per set.
+
+static constexpr std::size_t kBtSymbols = 8;
+static constexpr std::uint64_t kBtGap = 100'000;        // ns between events
+
+struct CrossoverParams {
+    double fast = 0.2;                  // EMA weights of the newest mid
+    double slow = 0.02;
+    double band = 1e-4;                 // |fast/slow - 1| needed to go long or short
+    std::uint32_t qty = 100;
+};
+
+// Long qty when the fast EMA is above the slow one by more than band, short qty when below,
+// one order in flight per symbol.
+class CrossoverStrategy {
+
+public:
+
+    explicit CrossoverStrategy(const CrossoverParams& iParams)
+        : mParams(iParams), mSymbols(QuoteCache<>::capacity()) { }
+
+    void on_market(const MarketEvent& e, BacktestEngine& bt) {
+        if (e.type != MarketDataType::Quote || e.symbol >= mSymbols.size()) return;
+
+        State& s = mSymbols[e.symbol];
+        const double mid = 0.5 * (e.bid + e.ask);
+        if (s.updates++ == 0) s.fast = s.slow = mid;
+        s.fast += mParams.fast * (mid - s.fast);
+        s.slow += mParams.slow * (mid - s.slow);
+        if (s.updates < 64 || s.in_flight) return;
+
+        const double ratio = s.fast / s.slow - 1.0;
+        const int signal = (ratio > mParams.band) ? 1 : (ratio < -mParams.band) ? -1 : 0;
+        if (signal == 0) return;
+
+        Position p;
+        bt.position(e.symbol, p);
+        const double delta = signal * double(mParams.qty) - p.qty;
+        if (std::abs(delta) < 1.0) return;
+
+        bt.submit(e.symbol, delta > 0.0 ? Action::Buy : Action::Sell, static_cast<std::uint32_t>(std::abs(delta)));
+        s.in_flight = true;
+    }
+
+    void on_trade_update(const TradeUpdateMsg& u, BacktestEngine&) {
+        if (u.symbol >= mSymbols.size()) return;
+        if (u.event == TradeEvent::Fill || u.event == TradeEvent::Rejected) mSymbols[u.symbol].in_flight = false;
+    }
+
+private:
+
+    struct State {
+        double fast = 0.0;
+        double slow = 0.0;
+        std::uint64_t updates = 0;
+        bool in_flight = false;
+    };
+
+    CrossoverParams mParams;
+    std::vector<State> mSymbols;         // by SymbolId
+};
+
+static std::vector<MarketEvent> make_tape(std::uint64_t events) {
+    std::array<SymbolId, kBtSymbols> ids{};
+    for (std::size_t s = 0; s < kBtSymbols; ++s) {
+        char name[8];
+        std::snprintf(name, sizeof(name), "BT%zu", s);
+        ids[s] = SymbolTable::getInstance().intern(name);
+    }
+
+    // Fixed-seed xorshift so every run of the benchmark sees the same tape.
+    std::uint64_t x = 0x2545F4914F6CDD1Dull;
+    auto next = [&] {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    std::array<double, kBtSymbols> mid{};
+    for (std::size_t s = 0; s < kBtSymbols; ++s) mid[s] = 50.0 + 25.0 * double(s);
+
+    std::vector<MarketEvent> tape(events);
+    for (std::uint64_t i = 0; i < events; ++i) {
+        const std::size_t s = next() % kBtSymbols;
+        const double step = (double(next() % 2001) - 1000.0) * 2e-7;
+        mid[s] *= 1.0 + step;
+
+        MarketEvent& e = tape[i];
+        e.ts = (i + 1) * kBtGap;
+        e.symbol = ids[s];
+        if (i % 10 == 9) {
+            e.type = MarketDataType::Trade;
+            e.price = mid[s];
+            e.size = 100;
+        }
+        else {
+            e.type = MarketDataType::Quote;
+            e.bid = mid[s] - 0.005;
+            e.ask = mid[s] + 0.005;
+        }
+    }
+    return tape;
+}
+
+static void print_result(const char* label, const BacktestResult& r) {
+    std::cout << label << r.orders << " orders, " << r.fills << " fills, " << r.risk_rejects << " risk rejects, equity "
+        << r.equity << " (realized " << r.realized << ", unrealized " << r.unrealized << ", max drawdown " << r.max_drawdown << ")\n";
+}
+
+int run_backtest_benchmark(std::uint64_t events, unsigned threads)
+{
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::vector<MarketEvent> tape = make_tape(events);
+    const std::span<const MarketEvent> data{ tape };
+
+    BacktestConfig config;
+    config.limits.max_notional = 1e7;
+
+    const CrossoverParams base{};
+    BacktestResult first, second;
+    {
+        BacktestEngine bt(config);
+        CrossoverStrategy strategy(base);
+        first = bt.run(data, strategy);
+    }
+    {
+        BacktestEngine bt(config);
+        CrossoverStrategy strategy(base);
+        second = bt.run(data, strategy);
+    }
+
+    const double speedup = first.sim_seconds / first.wall_seconds;
+    std::cout << "Tape               : " << events << " events, " << kBtSymbols << " symbols, " << first.sim_seconds << " s simulated\n";
+    std::cout << "Single run         : " << first.wall_seconds << " s wall, " << double(first.events) / first.wall_seconds
+        << " events/s, " << speedup << "x real time\n";
+    print_result("  ", first);
+    std::cout << "Rerun              : " << (first == second ? "identical" : "DIFFERENT") << "\n";
+
+    // Sweep: fast x slow x band.
+    std::vector<CrossoverParams> sweep;
+    for (double fast : { 0.1, 0.2, 0.4 })
+        for (double slow : { 0.01, 0.02, 0.05 })
+            for (double band : { 5e-5, 2e-4 })
+                sweep.push_back({ fast, slow, band, 100 });
+
+    auto make = [](const CrossoverParams& p) { return CrossoverStrategy(p); };
+    const std::span<const CrossoverParams> params{ sweep };
+
+    auto t0 = std::chrono::steady_clock::now();
+    const std::vector<BacktestResult> parallel = run_backtests(data, params, make, config, threads);
+    const double parallel_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    t0 = std::chrono::steady_clock::now();
+    const std::vector<BacktestResult> serial = run_backtests(data, params, make, config, 1);
+    const double serial_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const bool same = (parallel == serial);
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < parallel.size(); ++i) {
+        if (parallel[i].equity > parallel[best].equity) best = i;
+    }
+
+    std::cout << "Sweep              : " << sweep.size() << " parameter sets, " << threads << " threads " << parallel_s
+        << " s, 1 thread " << serial_s << " s (" << serial_s / parallel_s << "x), results "
+        << (same ? "identical" : "DIFFERENT") << "\n";
+    std::cout << "Best               : fast=" << sweep[best].fast << " slow=" << sweep[best].slow << " band=" << sweep[best].band << "\n";
+    print_result("  ", parallel[best]);
+
+    const bool pass = first == second && same && speedup > 1.0;
+    std::cout << "Backtest           : " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
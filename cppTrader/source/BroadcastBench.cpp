@@ -0,0 +1,131 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "OrderType.h"
+#include "FastQueue.hpp"
+#include "FastQueueBroadcast.hpp"
+
+// One decoder thread feeding N strategy threads:
+//   (a) one BroadcastFastQueue, every consumer with its own cursor over the shared ring
+//   (b) one FastQueue per consumer, the producer writing every message N times
+// The producer-side cost per message is what matters: (a) should stay flat as N grows.
+
+constexpr std::size_t kBroadcastMaxConsumers = 8;
+
+using BroadcastQ = BroadcastFastQueue<(1u << 20), 8, (1u << 12), kBroadcastMaxConsumers>;
+using BroadcastConsumer = BroadcastFastQueueConsumer<(1u << 20), 8, (1u << 12), kBroadcastMaxConsumers>;
+using CopyQ = FastQueue<(1u << 20), 8, (1u << 12)>;
+
+struct BroadcastRun {
+    double producer_ns_per_msg = 0.0;
+    double seconds = 0.0;
+    std::vector<std::uint64_t> checksums;
+};
+
+template <class Consumer>
+static void drain_all(Consumer& c, std::uint64_t messages, std::uint64_t& checksum) {
+    std::uint64_t consumed = 0;
+    while (consumed < messages) {
+        consumed += c.read_batch([&](std::span<const std::byte> frame) {
+            OrderMsg m;
+            std::memcpy(&m, frame.data(), sizeof(m));
+            checksum += (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
+            });
+    }
+}
+
+template <class Produce>
+static BroadcastRun time_producer(std::uint64_t messages, boost::barrier& start, std::vector<boost::thread>& threads, Produce&& produce) {
+    pin_current_thread_to_cpu(0);
+    start.wait();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < messages; ++i) {
+        produce(make_msg(i, (i & 1) == 0));
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (auto& t : threads) t.join();
+    const auto t2 = std::chrono::steady_clock::now();
+
+    BroadcastRun r;
+    r.producer_ns_per_msg = std::chrono::duration<double, std::nano>(t1 - t0).count() / double(messages);
+    r.seconds = std::chrono::duration<double>(t2 - t0).count();
+    return r;
+}
+
+static BroadcastRun run_broadcast(std::uint64_t messages, unsigned consumers) {
+    BroadcastQ q;
+    auto prod = q.make_producer(OverflowPolicy::SpinWait);
+    boost::barrier start(consumers + 1);
+
+    // Attach every consumer before the producer starts so nobody joins mid-stream.
+    std::vector<BroadcastConsumer> cons;
+    cons.reserve(consumers);
+    for (unsigned c = 0; c < consumers; ++c) cons.push_back(q.make_consumer());
+
+    std::vector<std::uint64_t> checksums(consumers, 0);
+    std::vector<boost::thread> threads;
+    for (unsigned c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            pin_current_thread_to_cpu(c + 1);
+            start.wait();
+            drain_all(cons[c], messages, checksums[c]);
+            });
+    }
+
+    BroadcastRun r = time_producer(messages, start, threads, [&](const OrderMsg& m) {
+        prod.write(std::as_bytes(std::span{ &m, 1 }));
+        });
+    r.checksums = std::move(checksums);
+    return r;
+}
+
+static BroadcastRun run_copies(std::uint64_t messages, unsigned consumers) {
+    std::vector<std::unique_ptr<CopyQ>> queues;
+    std::vector<FastQueueProducer<(1u << 20), 8, (1u << 12)>> producers;
+    for (unsigned c = 0; c < consumers; ++c) {
+        queues.push_back(std::make_unique<CopyQ>());
+        producers.push_back(queues.back()->make_producer());
+    }
+    boost::barrier start(consumers + 1);
+
+    std::vector<std::uint64_t> checksums(consumers, 0);
+    std::vector<boost::thread> threads;
+    for (unsigned c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c, cons = queues[c]->make_consumer()]() mutable {
+            pin_current_thread_to_cpu(c + 1);
+            start.wait();
+            drain_all(cons, messages, checksums[c]);
+            });
+    }
+
+    BroadcastRun r = time_producer(messages, start, threads, [&](const OrderMsg& m) {
+        for (auto& p : producers) p.write(std::as_bytes(std::span{ &m, 1 }));
+        });
+    r.checksums = std::move(checksums);
+    return r;
+}
+
+int run_broadcast_benchmark(std::uint64_t messages, unsigned max_consumers)
+{
+    max_consumers = std::min<unsigned>(max_consumers, kBroadcastMaxConsumers);
+
+    std::cout << "Messages   : " << messages << " (" << sizeof(OrderMsg) << " bytes)\n";
+    std::cout << "consumers  broadcast ns/write  N x copy ns/write  broadcast msg/s  N x copy msg/s  checksums\n";
+
+    for (unsigned consumers = 1; consumers <= max_consumers; consumers *= 2) {
+        const BroadcastRun a = run_broadcast(messages, consumers);
+        const BroadcastRun b = run_copies(messages, consumers);
+
+        bool match = (a.checksums == b.checksums);
+        for (const auto c : a.checksums) match = match && (c == a.checksums.front());
+
+        std::cout << "  " << consumers
+            << "        " << a.producer_ns_per_msg
+            << "            " << b.producer_ns_per_msg
+            << "            " << double(messages) / a.seconds
+            << "      " << double(messages) / b.seconds
+            << "      " << (match ? "match" : "MISMATCH") << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "common.h"
+#include "Benchmark.h"
+#include "TradeUpdateDecoder.h"
+#include <nlohmann/json.hpp>
+
+// ns/message for a typical trade_updates fill: nlohmann DOM (what run_one_session used to do)
+// against TradeUpdateDecoder, for single-message frames and a 64-message batched frame.
+
+static const char* kSampleFill =
+    R"({"stream":"trade_updates","data":{"event":"fill","execution_id":"7922ab44-ec8f-4c4b-a3d7-0d3e2b4c8f1a",)"
+    R"("order":{"id":"61e69015-8549-4bfd-b9c3-01e75843f47d","client_order_id":"Default-q-42",)"
+    R"("created_at":"2026-01-05T14:30:00.123456Z","updated_at":"2026-01-05T14:30:00.234567Z",)"
+    R"("submitted_at":"2026-01-05T14:30:00.123456Z","filled_at":"2026-01-05T14:30:00.234567Z",)"
+    R"("expired_at":null,"canceled_at":null,"failed_at":null,"replaced_at":null,"replaced_by":null,)"
+    R"("replaces":null,"asset_id":"b0b6dd9d-8b9b-48a9-ba46-b9d54906e415","symbol":"AAPL",)"
+    R"("asset_class":"us_equity","notional":null,"qty":"3","filled_qty":"3","filled_avg_price":"179.08",)"
+    R"("order_class":"","order_type":"market","type":"market","side":"buy","time_in_force":"day",)"
+    R"("limit_price":null,"stop_price":null,"status":"filled","extended_hours":false,"legs":null,)"
+    R"("trail_percent":null,"trail_price":null,"hwm":null},)"
+    R"("position_qty":"3","price":"179.08","qty":"3","timestamp":"2026-01-05T14:30:00.234567Z"}})";
+
+template <class F>
+static double ns_per_op(std::uint64_t iterations, F&& op) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        op();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / double(iterations);
+}
+
+int run_decoder_benchmark(std::uint64_t iterations)
+{
+    const std::string frame = kSampleFill;
+
+    constexpr std::size_t kBatch = 64;
+    std::string batch = "[";
+    for (std::size_t i = 0; i < kBatch; ++i) {
+        if (i) batch += ",";
+        batch += frame;
+    }
+    batch += "]";
+
+    std::uint64_t sink = 0;
+
+    const double dom_ns = ns_per_op(iterations, [&] {
+        const nlohmann::json j = nlohmann::json::parse(frame);
+        const auto& d = j["data"];
+        const auto& o = d["order"];
+        sink += d["event"].get_ref<const std::string&>().size();
+        sink += o["symbol"].get_ref<const std::string&>().size();
+        sink += static_cast<std::uint64_t>(std::stod(d["price"].get_ref<const std::string&>()));
+        });
+
+    const double decoder_ns = ns_per_op(iterations, [&] {
+        TradeUpdateView v;
+        if (TradeUpdateDecoder::decode(frame, v) == TradeUpdateDecoder::Status::Ok) {
+            sink += v.event.size() + v.symbol.size();
+            sink += static_cast<std::uint64_t>(TradeUpdateDecoder::as_double(v.price));
+        }
+        });
+
+    const std::uint64_t batch_iterations = std::max<std::uint64_t>(iterations / kBatch, 1);
+
+    const double dom_batch_ns = ns_per_op(batch_iterations, [&] {
+        const nlohmann::json j = nlohmann::json::parse(batch);
+        for (const auto& m : j) {
+            sink += m["data"]["order"]["symbol"].get_ref<const std::string&>().size();
+        }
+        }) / double(kBatch);
+
+    const double decoder_batch_ns = ns_per_op(batch_iterations, [&] {
+        TradeUpdateDecoder::for_each(batch, [&](const TradeUpdateView& v) {
+            sink += v.symbol.size();
+            });
+        }) / double(kBatch);
+
+    TradeUpdateView v;
+    TradeUpdateDecoder::decode(frame, v);
+
+    std::cout << "Frame size         : " << frame.size() << " bytes\n";
+    std::cout << "nlohmann DOM       : " << dom_ns << " ns/msg\n";
+    std::cout << "TradeUpdateDecoder : " << decoder_ns << " ns/msg (" << dom_ns / decoder_ns << "x)\n";
+    std::cout << "Batched x" << kBatch << " DOM    : " << dom_batch_ns << " ns/msg\n";
+    std::cout << "Batched x" << kBatch << " decode : " << decoder_batch_ns << " ns/msg (" << dom_batch_ns / decoder_batch_ns << "x)\n";
+    std::cout << "SSE2 scan          : " << (CPPTRADER_HAS_SSE2 ? "yes" : "no") << "\n";
+    std::cout << "Decoded            : " << v.event << " " << v.side << " " << v.qty << " " << v.symbol
+              << " @ " << v.price << " order=" << v.order_id << "\n";
+    std::cout << "Sink               : " << sink << "\n";
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "common.h"
+#include "Benchmark.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Offline view of histograms saved with save_histogram(): one column per file, and the change
+// of each percentile relative to the first file when several are given.
+
+static constexpr double kReportPercentiles[] = { 0.50, 0.90, 0.99, 0.999, 0.9999 };
+
+bool save_histogram(const HdrHistogram& h, const std::string& path)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    const std::string bytes = h.encode();
+    f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(f);
+}
+
+HdrHistogram load_histogram(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open " + path);
+
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return HdrHistogram::decode(ss.str());
+}
+
+int run_hdr_report(const std::vector<std::string>& files)
+{
+    if (files.empty()) {
+        std::cerr << "usage: cppTrader hdr-report <a.hdr> [b.hdr ...]\n";
+        return 2;
+    }
+
+    std::vector<HdrHistogram> hists;
+    for (const auto& f : files) hists.push_back(load_histogram(f));
+
+    // Every cell, header or value, is one fixed-width column: the value, then its change
+    // against the first file. Columns are numbered and the files listed in a legend above.
+    constexpr int kValueWidth = 12;
+    constexpr int kDeltaWidth = 11;
+    const char* const kSeparator = " |";
+
+    auto row = [&](const char* label, auto value_of) {
+        std::cout << std::left << std::setw(10) << label << std::right;
+        const double base = static_cast<double>(value_of(hists.front()));
+        for (const auto& h : hists) {
+            const double v = static_cast<double>(value_of(h));
+            std::ostringstream delta;
+            if (&h != &hists.front() && base > 0) {
+                delta << "(" << std::showpos << std::fixed << std::setprecision(1) << (v - base) * 100.0 / base << "%)";
+            }
+            std::cout << kSeparator << std::setw(kValueWidth) << static_cast<std::uint64_t>(v)
+                      << std::setw(kDeltaWidth) << delta.str();
+        }
+        std::cout << "\n";
+    };
+
+    for (std::size_t i = 0; i < files.size(); ++i) std::cout << "[" << i + 1 << "] " << files[i] << "\n";
+
+    std::cout << std::left << std::setw(10) << "ns" << std::right;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::cout << kSeparator << std::setw(kValueWidth) << "[" + std::to_string(i + 1) + "]" << std::setw(kDeltaWidth) << "";
+    }
+    std::cout << "\n";
+
+    row("count", [](const HdrHistogram& h) { return h.total; });
+    row("min", [](const HdrHistogram& h) { return h.min_value(); });
+    for (const double p : kReportPercentiles) {
+        std::ostringstream label;
+        label << "p" << p * 100.0;
+        row(label.str().c_str(), [p](const HdrHistogram& h) { return h.percentile(p); });
+    }
+    row("max", [](const HdrHistogram& h) { return h.max_value(); });
+    row("mean", [](const HdrHistogram& h) { return static_cast<std::uint64_t>(h.mean()); });
+    return 0;
+}
@@ -0,0 +1,327 @@
+#include "HttpsConnectionPool.h"
+#include "Clock.h"
+
+
+HttpsConnectionPool::HttpsConnectionPool(asio::any_io_executor iExecutor, ssl::context& iTlsCtx, std::string iHost, std::string iPort, Config iConfig)
+    : mExecutor(std::move(iExecutor)), mTlsCtx(iTlsCtx), mHost(std::move(iHost)), mPort(std::move(iPort)), mConfig(iConfig), mReleased(mExecutor)
+{
+    mConnections.reserve(mConfig.connections);
+    for (std::size_t i = 0; i < mConfig.connections; ++i) {
+        mConnections.push_back(std::make_unique<Connection>());
+    }
+
+    // Never expires: waiters are woken one at a time by cancel_one() in release().
+    mReleased.expires_at(std::chrono::steady_clock::time_point::max());
+}
+
+std::size_t HttpsConnectionPool::open_count() const {
+    std::size_t n = 0;
+    for (const auto& c : mConnections) {
+        n += c->open ? 1 : 0;
+    }
+    return n;
+}
+
+awaitable<void> HttpsConnectionPool::resolve() {
+    beast::error_code ec;
+    tcp::resolver resolver(mExecutor);
+    auto results = co_await resolver.async_resolve(mHost, mPort, asio::redirect_error(use_awaitable, ec));
+    if (ec) throw beast::system_error(ec, "resolve");
+
+    mEndpoints = std::move(results);
+}
+
+awaitable<void> HttpsConnectionPool::warm_up() {
+    co_await resolve();
+
+    for (auto& c : mConnections) {
+        if (c->open || c->busy) continue;
+
+        // Hold the slot so a concurrent request() does not use a half-open socket.
+        c->busy = true;
+        Lease lease(*this, *c);
+        co_await connect(*c);
+    }
+}
+
+awaitable<void> HttpsConnectionPool::connect(Connection& c) {
+    beast::error_code ec;
+
+    if (mEndpoints.empty()) {
+        co_await resolve();
+    }
+
+    c.stream = std::make_unique<beast::ssl_stream<beast::tcp_stream>>(mExecutor, mTlsCtx);
+
+    // SNI
+    if (!SSL_set_tlsext_host_name(c.stream->native_handle(), mHost.c_str())) {
+        beast::error_code sni_ec(
+            static_cast<int>(::ERR_get_error()),
+            asio::error::get_ssl_category()
+        );
+        throw beast::system_error(sni_ec, "SNI");
+    }
+
+    auto& lowest = beast::get_lowest_layer(*c.stream);
+
+    lowest.expires_after(mConfig.io_timeout);
+    co_await lowest.async_connect(mEndpoints, asio::redirect_error(use_awaitable, ec));
+    if (ec) {
+        // DNS may have moved us; resolve again on the next attempt.
+        mEndpoints = {};
+        throw beast::system_error(ec, "connect");
+    }
+
+    lowest.socket().set_option(tcp::no_delay(true));
+
+    co_await c.stream->async_handshake(ssl::stream_base::client, asio::redirect_error(use_awaitable, ec));
+    if (ec) throw beast::system_error(ec, "tls_handshake");
+
+    lowest.expires_never();
+
+    // Only affects synchronous calls, i.e. the MSG_PEEK probe in is_stale().
+    lowest.socket().non_blocking(true);
+
+    c.buffer.clear();
+    c.requests = 0;
+    c.open = true;
+    c.last_used = std::chrono::steady_clock::now();
+}
+
+void HttpsConnectionPool::close(Connection& c) {
+    if (c.stream) {
+        // No TLS close_notify: the socket is being thrown away, the extra round trip buys nothing.
+        beast::error_code ec;
+        auto& sock = beast::get_lowest_layer(*c.stream).socket();
+        sock.shutdown(tcp::socket::shutdown_both, ec);
+        sock.close(ec);
+    }
+    c.open = false;
+}
+
+bool HttpsConnectionPool::is_stale(Connection& c) const {
+    if (!c.open) return true;
+
+    if (std::chrono::steady_clock::now() - c.last_used > mConfig.idle_refresh) return true;
+
+    // An idle keep-alive socket must have nothing to read. EOF, a reset or unsolicited
+    // bytes (usually a TLS close_notify) all mean the server has given up on it.
+    char probe = 0;
+    beast::error_code ec;
+    beast::get_lowest_layer(*c.stream).socket().receive(asio::buffer(&probe, 1), tcp::socket::message_peek, ec);
+    return ec != asio::error::would_block;
+}
+
+awaitable<HttpsConnectionPool::Connection*> HttpsConnectionPool::acquire() {
+    for (;;) {
+        Connection* fallback = nullptr;
+        for (auto& c : mConnections) {
+            if (c->busy) continue;
+            if (c->open) {
+                c->busy = true;
+                co_return c.get();
+            }
+            if (!fallback) fallback = c.get();
+        }
+
+        if (fallback) {
+            fallback->busy = true;
+            co_return fallback;
+        }
+
+        beast::error_code ec;
+        co_await mReleased.async_wait(asio::redirect_error(use_awaitable, ec));
+    }
+}
+
+void HttpsConnectionPool::release(Connection& c) {
+    c.busy = false;
+    mReleased.cancel_one();
+}
+
+template <class Writer>
+awaitable<HttpsConnectionPool::Response> HttpsConnectionPool::exchange(Writer write, bool idempotent) {
+    Connection* conn = co_await acquire();
+    Lease lease(*this, *conn);
+
+    for (int attempt = 0;; ++attempt) {
+        if (!lease->open) {
+            co_await connect(*lease);
+        }
+
+        const bool reused = lease->requests > 0;
+        auto& lowest = beast::get_lowest_layer(*lease->stream);
+        beast::error_code ec;
+
+        lowest.expires_after(mConfig.io_timeout);
+        co_await write(*lease->stream, ec);
+        const bool written = !ec;
+
+        Response res;
+        if (written) {
+            co_await http::async_read(*lease->stream, lease->buffer, res, asio::redirect_error(use_awaitable, ec));
+        }
+
+        if (!ec) {
+            lowest.expires_never();
+            ++lease->requests;
+            lease->last_used = std::chrono::steady_clock::now();
+            if (!res.keep_alive()) close(*lease);
+            co_return res;
+        }
+
+        close(*lease);
+
+        // A reused socket the server already closed is the common keep-alive failure; a
+        // fresh connection failing means something real is wrong.
+        const bool retry = attempt == 0 && reused && (!written || idempotent);
+        if (!retry) throw beast::system_error(ec, written ? "http_read" : "http_write");
+    }
+}
+
+awaitable<HttpsConnectionPool::Response> HttpsConnectionPool::request(const Request& req) {
+    // Replaying a POST whose bytes reached the server could duplicate an order, so only
+    // idempotent requests are retried after the write went through.
+    const bool idempotent = req.method() == http::verb::get || req.method() == http::verb::delete_;
+
+    co_return co_await exchange(
+        [&req](beast::ssl_stream<beast::tcp_stream>& stream, beast::error_code& ec) -> awaitable<void> {
+            co_await http::async_write(stream, req, asio::redirect_error(use_awaitable, ec));
+        },
+        idempotent);
+}
+
+awaitable<HttpsConnectionPool::Response> HttpsConnectionPool::request_raw(std::string_view wire, bool idempotent, std::uint64_t* written_at) {
+    co_return co_await exchange(
+        [wire, written_at](beast::ssl_stream<beast::tcp_stream>& stream, beast::error_code& ec) -> awaitable<void> {
+            co_await asio::async_write(stream, asio::buffer(wire.data(), wire.size()), asio::redirect_error(use_awaitable, ec));
+            if (written_at) *written_at = TscClock::now();
+        },
+        idempotent);
+}
+
+awaitable<void> HttpsConnectionPool::pipeline_worker(PipelineBurst& burst) {
+    Connection* conn = co_await acquire();
+    Lease lease(*this, *conn);
+
+    std::deque<std::size_t> inflight;                   // request indices, in send order
+    bool reconnected = false;
+
+    while (burst.next < burst.requests.size() || !inflight.empty()) {
+        if (!lease->open) {
+            try
+            {
+                co_await connect(*lease);
+            }
+            catch (const std::exception&) {
+                // Leave the unclaimed requests to the other workers.
+                break;
+            }
+        }
+
+        auto& lowest = beast::get_lowest_layer(*lease->stream);
+        beast::error_code ec;
+        lowest.expires_after(mConfig.io_timeout);
+
+        // Top the window up, then read exactly one response.
+        while (!ec && inflight.size() < burst.window && burst.next < burst.requests.size()) {
+            const std::size_t idx = burst.next++;
+            inflight.push_back(idx);
+            co_await http::async_write(*lease->stream, burst.requests[idx], asio::redirect_error(use_awaitable, ec));
+        }
+
+        if (!ec) {
+            Response res;
+            co_await http::async_read(*lease->stream, lease->buffer, res, asio::redirect_error(use_awaitable, ec));
+
+            if (!ec) {
+                ++lease->requests;
+                lease->last_used = std::chrono::steady_clock::now();
+
+                const bool keep_alive = res.keep_alive();
+                burst.results[inflight.front()].response = std::move(res);
+                inflight.pop_front();
+
+                // The server will not answer anything queued behind a "Connection: close".
+                if (!keep_alive) ec = asio::error::connection_aborted;
+            }
+        }
+
+        if (!ec) continue;
+
+        for (const std::size_t idx : inflight) {
+            burst.results[idx].ec = ec;
+        }
+        inflight.clear();
+        close(*lease);
+
+        if (reconnected) break;
+        reconnected = true;
+    }
+
+    if (lease->open) {
+        beast::get_lowest_layer(*lease->stream).expires_never();
+    }
+}
+
+awaitable<std::vector<HttpsConnectionPool::PipelineResult>> HttpsConnectionPool::pipeline(std::span<const Request> requests, std::size_t iWindow) {
+    std::vector<PipelineResult> results(requests.size());
+    if (requests.empty()) co_return results;
+
+    PipelineBurst burst{ requests, results, std::max<std::size_t>(iWindow, 1) };
+
+    // No point holding a connection that would never fill its window.
+    const std::size_t wanted = (requests.size() + burst.window - 1) / burst.window;
+    std::size_t active = std::min(wanted, mConnections.size());
+
+    asio::steady_timer done(mExecutor);
+    done.expires_at(std::chrono::steady_clock::time_point::max());
+
+    // Workers share this frame by reference; it stays alive until the last one reports back.
+    const std::size_t workers = active;
+    for (std::size_t i = 0; i < workers; ++i) {
+        asio::co_spawn(mExecutor, pipeline_worker(burst),
+            [&](std::exception_ptr) {
+                if (--active == 0) done.cancel();
+            });
+    }
+
+    while (active > 0) {
+        beast::error_code ec;
+        co_await done.async_wait(asio::redirect_error(use_awaitable, ec));
+    }
+
+    // Every worker lost its connection before these were sent.
+    for (std::size_t i = burst.next; i < requests.size(); ++i) {
+        results[i].ec = asio::error::not_connected;
+    }
+
+    co_return results;
+}
+
+awaitable<void> HttpsConnectionPool::maintain_forever() {
+    asio::steady_timer t(mExecutor);
+
+    while (true)
+    {
+        t.expires_after(mConfig.health_interval);
+        co_await t.async_wait(use_awaitable);
+
+        for (auto& c : mConnections) {
+            if (c->busy || !is_stale(*c)) continue;
+
+            c->busy = true;
+            Lease lease(*this, *c);
+            close(*c);
+
+            try
+            {
+                co_await connect(*c);
+            }
+            catch (const std::exception& e) {
+                // request() will try again on demand.
+                std::cerr << "[rest pool] reconnect to " << mHost << " failed: " << e.what() << "\n";
+            }
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include "Journal.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+
+std::string JournalWriter::segment_path(const std::string& iDir, const std::string& iName, std::uint64_t iIndex)
+{
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%06llu.fqj", static_cast<unsigned long long>(iIndex));
+    return (fs::path(iDir) / (iName + suffix)).string();
+}
+
+JournalWriter::JournalWriter(Config iConfig)
+    : mConfig(std::move(iConfig))
+{
+    if (mConfig.segment_bytes <= kJournalHeaderBytes) throw std::invalid_argument("JournalWriter: segment_bytes too small");
+
+    fs::create_directories(mConfig.dir);
+
+    // Segments left by an earlier journal of the same name would be read as part of this one.
+    for (std::uint64_t i = 0; fs::remove(segment_path(mConfig.dir, mConfig.name, i)); ++i) { }
+
+    mCurrent = create_segment(0);
+    mSpare = create_segment(1);
+}
+
+JournalWriter::~JournalWriter()
+{
+    publish();
+    mCurrent.flush_async();
+
+    // The spare was never written to.
+    const std::string spare = mSpare.path();
+    mSpare = MappedFile{};
+    std::error_code ec;
+    fs::remove(spare, ec);
+}
+
+MappedFile JournalWriter::create_segment(std::uint64_t iIndex) const
+{
+    MappedFile f = MappedFile::create(segment_path(mConfig.dir, mConfig.name, iIndex), mConfig.segment_bytes);
+
+    auto* h = new (f.data()) JournalSegmentHeader{};
+    h->version = kJournalVersion;
+    h->header_bytes = static_cast<std::uint32_t>(kJournalHeaderBytes);
+    h->segment = iIndex;
+    h->ticks_per_sec = TscClock::frequency();
+    h->magic = kJournalMagic;
+    return f;
+}
+
+void JournalWriter::append(std::uint64_t ts, std::span<const std::byte> payload)
+{
+    const std::size_t frame_bytes = sizeof(JournalFrameHeader) + align_up<kJournalAlignment>(payload.size());
+    const std::size_t room = mConfig.segment_bytes - kJournalHeaderBytes;
+    if (frame_bytes > room) throw std::length_error("JournalWriter: frame larger than a segment");
+
+    if (mUsed + frame_bytes > room) rotate();
+
+    // The file is zero-filled, so the padding needs no store.
+    std::byte* p = mCurrent.data() + kJournalHeaderBytes + mUsed;
+    const JournalFrameHeader h{ static_cast<std::int32_t>(payload.size()), 0, ts };
+    std::memcpy(p, &h, sizeof(h));
+    std::memcpy(p + sizeof(h), payload.data(), payload.size());
+
+    mUsed += frame_bytes;
+    ++mSegmentFrames;
+    ++mFrames;
+    mBytes += payload.size();
+}
+
+void JournalWriter::publish() noexcept
+{
+    if (!mCurrent.data()) return;
+
+    auto* h = reinterpret_cast<JournalSegmentHeader*>(mCurrent.data());
+    h->frames.store(mSegmentFrames, std::memory_order_relaxed);
+    h->used.store(mUsed, std::memory_order_release);
+}
+
+void JournalWriter::rotate()
+{
+    publish();
+    mCurrent.flush_async();
+
+    mCurrent = std::move(mSpare);
+    ++mIndex;
+    mUsed = 0;
+    mSegmentFrames = 0;
+
+    mSpare = create_segment(mIndex + 1);
+}
+
+
+JournalReader::JournalReader(const std::string& iDir, const std::string& iName)
+{
+    for (std::uint64_t i = 0;; ++i) {
+        const std::string path = JournalWriter::segment_path(iDir, iName, i);
+        if (!fs::exists(path)) break;
+
+        MappedFile seg = MappedFile::open(path);
+        if (seg.size() < kJournalHeaderBytes) throw std::runtime_error("journal segment too small: " + path);
+
+        const JournalSegmentHeader& h = header(seg);
+        if (h.magic != kJournalMagic || h.version != kJournalVersion || h.segment != i
+            || h.used.load(std::memory_order_acquire) > seg.size() - kJournalHeaderBytes) {
+            throw std::runtime_error("not a journal segment: " + path);
+        }
+
+        // An empty segment ends the journal (a spare left by a crashed writer).
+        if (h.frames.load(std::memory_order_relaxed) == 0) break;
+
+        mTicksPerSec = h.ticks_per_sec;
+        mSegments.push_back(std::move(seg));
+    }
+    if (mSegments.empty()) throw std::runtime_error("no journal " + iName + " in " + iDir);
+
+    bool first = true;
+    for_each([&](std::uint64_t ts, std::span<const std::byte> payload) {
+        if (first) mFirstTs = ts;
+        first = false;
+        mLastTs = ts;
+        ++mFrames;
+        mBytes += payload.size();
+        });
+}
+
+
+// Any frame that fits the staging ring must fit a segment, or the journal thread would throw.
+JournalWriter::Config JournalTap::checked(JournalWriter::Config iConfig)
+{
+    if (iConfig.segment_bytes < kJournalHeaderBytes + StagingQueue::kMappingBytes) {
+        throw std::invalid_argument("JournalTap: segment_bytes smaller than the staging ring");
+    }
+    return iConfig;
+}
+
+JournalTap::JournalTap(Config iConfig)
+    : mStaging(mQueue.make_producer()), mDrain(mQueue.make_consumer()), mWriter(checked(std::move(iConfig.journal))),
+      mLossless(iConfig.lossless)
+{
+    mSegments.store(mWriter.segments(), std::memory_order_relaxed);
+    mThread = boost::thread([this] { run(); });
+}
+
+JournalTap::~JournalTap()
+{
+    mStop.store(true, std::memory_order_release);
+    mThread.join();
+}
+
+std::size_t JournalTap::drain()
+{
+    const std::size_t n = mDrain.read_batch([&](std::span<const std::byte> frame) {
+        std::uint64_t ts = 0;
+        std::memcpy(&ts, frame.data(), sizeof(ts));
+        mWriter.append(ts, frame.subspan(sizeof(ts)));
+        });
+    if (n == 0) return 0;
+
+    mWriter.publish();
+    mFrames.store(mWriter.frames(), std::memory_order_relaxed);
+    mBytes.store(mWriter.bytes(), std::memory_order_relaxed);
+    mSegments.store(mWriter.segments(), std::memory_order_relaxed);
+    return n;
+}
+
+void JournalTap::run()
+{
+    // Disk-side thread: nothing here is latency sensitive, so an idle ring means a short sleep.
+    while (!mStop.load(std::memory_order_acquire)) {
+        if (drain() == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    while (drain() != 0) { }
+}
+
+JournalTap::Stats JournalTap::stats() const noexcept
+{
+    Stats s;
+    s.frames = mFrames.load(std::memory_order_relaxed);
+    s.bytes = mBytes.load(std::memory_order_relaxed);
+    s.dropped = mDropped.load(std::memory_order_relaxed);
+    s.segments = mSegments.load(std::memory_order_relaxed);
+    return s;
+}
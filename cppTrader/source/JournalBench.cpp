@@ -0,0 +1,151 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "Journal.h"
+#include "OrderType.h"
+#include "TradeUpdatePipeline.h"
+
+// Journal tap and replay on OrderMsg traffic:
+//   1. producer cost per frame, first on a bare FastQueue, then through a JournaledProducer
+//      whose tap writes rotating kJournalSegment segments on its own thread;
+//   2. that journal replayed at maximum speed into a fresh queue (same checksum, throughput);
+//   3. a paced recording (one frame every kPacedGap) replayed at original pacing, with the
+//      lateness against the recorded schedule.
+// "journal-replay <dir> <name> [paced]" replays any journal the same way.
+
+using JournalQ = FastQueue<(1u << 20), 8, (1u << 12)>;
+
+static constexpr std::size_t kJournalSegment = std::size_t(16) << 20;
+static constexpr std::uint64_t kPacedFrames = 20'000;
+static constexpr auto kPacedGap = std::chrono::microseconds(25);
+
+static std::uint64_t frame_checksum(std::span<const std::byte> frame) {
+    OrderMsg m;
+    std::memcpy(&m, frame.data(), std::min(frame.size(), sizeof(m)));
+    return (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
+}
+
+// Drains q on its own thread until `frames` were read; returns their checksum.
+struct QueueSink {
+    explicit QueueSink(JournalQ& q, std::uint64_t frames)
+        : cons(q.make_consumer()), thr([this, frames] {
+            pin_current_thread_to_cpu(1);
+            while (consumed < frames) {
+                consumed += cons.read_batch([&](std::span<const std::byte> f) { checksum += frame_checksum(f); });
+            }
+            }) { }
+
+    std::uint64_t join() {
+        thr.join();
+        return checksum;
+    }
+
+    FastQueueConsumer<(1u << 20), 8, (1u << 12)> cons;
+    std::uint64_t consumed = 0;
+    std::uint64_t checksum = 0;
+    boost::thread thr;
+};
+
+// ns per producer write of `messages` OrderMsg frames, with or without a tap.
+static double produce(std::uint64_t messages, JournalTap* tap, std::uint64_t& checksum) {
+    JournalQ q;
+    QueueSink sink(q, messages);
+    JournaledProducer prod(q.make_producer(), tap);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < messages; ++i) {
+        const OrderMsg m = make_msg(i, (i & 1) == 0);
+        prod.write(std::as_bytes(std::span{ &m, 1 }));
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    checksum = sink.join();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / double(messages);
+}
+
+static ReplayStats replay(const JournalReader& journal, ReplayPacing pacing, std::uint64_t& checksum) {
+    JournalQ q;
+    QueueSink sink(q, journal.frames());
+    auto prod = q.make_producer();
+    ReplayStats st = replay_journal(journal, prod, pacing);
+    checksum = sink.join();
+    return st;
+}
+
+static void print_journal(const JournalReader& journal) {
+    const double span_s = double(journal.last_ts() - journal.first_ts()) / double(journal.ticks_per_sec());
+    std::cout << "Journal            : " << journal.frames() << " frames, " << journal.bytes() << " payload bytes in "
+        << journal.segments() << " segments, " << span_s << " s recorded\n";
+}
+
+int run_journal_benchmark(const std::string& dir, std::uint64_t messages)
+{
+    pin_current_thread_to_cpu(0);
+
+    std::uint64_t bare_sum = 0, tapped_sum = 0;
+    const double bare_ns = produce(messages, nullptr, bare_sum);
+
+    JournalTap::Stats tap_stats;
+    double tapped_ns = 0.0;
+    {
+        JournalTap tap({ { dir, "orders", kJournalSegment }, false });
+        tapped_ns = produce(messages, &tap, tapped_sum);
+        while (tap.stats().frames + tap.stats().dropped < messages) boost::this_thread::yield();
+        tap_stats = tap.stats();
+    }
+
+    std::cout << "Producer           : " << bare_ns << " ns/frame bare, " << tapped_ns << " ns/frame tapped ("
+        << messages << " x " << sizeof(OrderMsg) << " B)\n";
+    std::cout << "Tap                : " << tap_stats.frames << " journaled, " << tap_stats.dropped << " dropped, "
+        << tap_stats.segments << " segments of " << (kJournalSegment >> 20) << " MiB in " << dir << "\n";
+
+    const JournalReader journal(dir, "orders");
+    print_journal(journal);
+
+    std::uint64_t replay_sum = 0;
+    const ReplayStats fast = replay(journal, ReplayPacing::MaxSpeed, replay_sum);
+    std::cout << "Replay max speed   : " << fast.frames << " frames in " << fast.seconds << " s, "
+        << double(fast.frames) / fast.seconds << " frames/s, checksum " << (replay_sum == tapped_sum ? "match" : "MISMATCH") << "\n";
+
+    // A recording with real gaps, replayed on its original schedule.
+    {
+        JournalTap tap({ { dir, "paced", kJournalSegment }, true });
+        JournalQ q;
+        QueueSink sink(q, kPacedFrames);
+        JournaledProducer prod(q.make_producer(), &tap);
+        auto next = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < kPacedFrames; ++i) {
+            while (std::chrono::steady_clock::now() < next) cpu_relax();
+            next += kPacedGap;
+            const OrderMsg m = make_msg(i, (i & 1) == 0);
+            prod.write(std::as_bytes(std::span{ &m, 1 }));
+        }
+        sink.join();
+    }
+    const JournalReader paced_journal(dir, "paced");
+    const double recorded_s = double(paced_journal.last_ts() - paced_journal.first_ts()) / double(paced_journal.ticks_per_sec());
+    std::uint64_t paced_sum = 0;
+    const ReplayStats paced = replay(paced_journal, ReplayPacing::Original, paced_sum);
+    std::cout << "Replay paced       : " << paced.frames << " frames in " << paced.seconds << " s (recorded "
+        << recorded_s << " s)\n";
+    print_stage("lateness   ", paced.lateness);
+
+    const bool pass = tap_stats.dropped == 0 && journal.frames() == messages && replay_sum == tapped_sum
+        && tapped_sum == bare_sum && paced.frames == kPacedFrames;
+    std::cout << "Journal / replay   : " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
+
+int run_journal_replay(const std::string& dir, const std::string& name, bool paced)
+{
+    const JournalReader journal(dir, name);
+    print_journal(journal);
+
+    pin_current_thread_to_cpu(0);
+    std::uint64_t checksum = 0;
+    const ReplayStats st = replay(journal, paced ? ReplayPacing::Original : ReplayPacing::MaxSpeed, checksum);
+    std::cout << "Replay             : " << st.frames << " frames, " << st.bytes << " bytes in " << st.seconds << " s, "
+        << double(st.frames) / st.seconds << " frames/s\n";
+    if (paced) print_stage("lateness   ", st.lateness);
+    return 0;
+}
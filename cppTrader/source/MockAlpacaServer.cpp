@@ -0,0 +1,451 @@
+#include "MockAlpacaServer.h"
+
+#include <cstdio>
+#include <ctime>
+#include <optional>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+namespace {
+
+using Request = http::request<http::string_body>;
+using Response = http::response<http::string_body>;
+
+// 2024-05-01T13:45:12.123456789Z
+std::string utc_timestamp()
+{
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t secs = std::chrono::system_clock::to_time_t(now);
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() % 1'000'000'000;
+
+    std::tm tm{};
+#ifdef _WIN32
+    gmtime_s(&tm, &secs);
+#else
+    gmtime_r(&secs, &tm);
+#endif
+    char buf[48];
+    const std::size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    std::snprintf(buf + n, sizeof(buf) - n, ".%09lldZ", static_cast<long long>(nanos));
+    return buf;
+}
+
+// Alpaca error body: {"code":40010001,"message":"..."}
+Response make_error(const Request& iReq, http::status iStatus, int iCode, std::string_view iMessage)
+{
+    Response res{ iStatus, iReq.version() };
+    res.set(http::field::content_type, "application/json");
+    res.keep_alive(iReq.keep_alive());
+    res.body() = nlohmann::json{ { "code", iCode }, { "message", iMessage } }.dump();
+    res.prepare_payload();
+    return res;
+}
+
+Response make_json(const Request& iReq, const nlohmann::json& iBody)
+{
+    Response res{ http::status::ok, iReq.version() };
+    res.set(http::field::content_type, "application/json");
+    res.keep_alive(iReq.keep_alive());
+    res.body() = iBody.dump();
+    res.prepare_payload();
+    return res;
+}
+
+std::string money(double v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f", v);
+    return buf;
+}
+
+// "10", "10.5" or 10
+double as_number(const nlohmann::json& v)
+{
+    if (v.is_number()) return v.get<double>();
+    if (v.is_string()) return std::strtod(v.get_ref<const std::string&>().c_str(), nullptr);
+    return 0.0;
+}
+
+// obj[key] if it is a string, iDefault if it is absent or null, nullopt for any other type.
+std::optional<std::string> string_field(const nlohmann::json& obj, const char* key, std::string_view iDefault = {})
+{
+    const auto it = obj.find(key);
+    if (it == obj.end() || it->is_null()) return std::string(iDefault);
+    if (!it->is_string()) return std::nullopt;
+    return it->get<std::string>();
+}
+
+struct PkeyDeleter { void operator()(EVP_PKEY* p) const { EVP_PKEY_free(p); } };
+struct X509Deleter { void operator()(X509* p) const { X509_free(p); } };
+struct BioDeleter { void operator()(BIO* p) const { BIO_free(p); } };
+
+[[noreturn]] void throw_openssl(const char* iWhat)
+{
+    throw beast::system_error(beast::error_code(static_cast<int>(::ERR_get_error()), asio::error::get_ssl_category()), iWhat);
+}
+
+template <class Write>
+std::string to_pem(Write&& iWrite)
+{
+    std::unique_ptr<BIO, BioDeleter> bio(BIO_new(BIO_s_mem()));
+    if (!bio || !iWrite(bio.get())) throw_openssl("PEM_write");
+
+    char* data = nullptr;
+    const long n = BIO_get_mem_data(bio.get(), &data);
+    return std::string(data, static_cast<std::size_t>(n));
+}
+
+}
+
+// trade_updates subscriber. Reads run in run(); frames queued by send() are written one at a
+// time by a second coroutine, since a websocket stream allows one read and one write in flight.
+class MockAlpacaServer::StreamSession : public std::enable_shared_from_this<StreamSession> {
+
+public:
+
+    StreamSession(MockAlpacaServer& iServer, beast::ssl_stream<beast::tcp_stream>&& iStream)
+        : mServer(iServer), mWs(std::move(iStream)) { }
+
+    awaitable<void> run(Request iUpgrade)
+    {
+        beast::error_code ec;
+        beast::get_lowest_layer(mWs).expires_never();
+        mWs.set_option(ws::stream_base::timeout::suggested(beast::role_type::server));
+        mWs.text(true);
+
+        co_await mWs.async_accept(iUpgrade, asio::redirect_error(use_awaitable, ec));
+        if (ec) co_return;
+
+        beast::flat_buffer buf;
+        for (;;) {
+            co_await mWs.async_read(buf, asio::redirect_error(use_awaitable, ec));
+            if (ec) break;
+
+            const nlohmann::json msg = nlohmann::json::parse(beast::buffers_to_string(buf.data()), nullptr, false);
+            buf.consume(buf.size());
+            if (!msg.is_object()) continue;
+
+            const std::string action = string_field(msg, "action").value_or("");
+            if (action == "auth" || action == "authenticate") {
+                mAuthorized = !string_field(msg, "key").value_or("").empty() && !string_field(msg, "secret").value_or("").empty();
+                send(nlohmann::json{ { "stream", "authorization" },
+                    { "data", { { "action", "authenticate" }, { "status", mAuthorized ? "authorized" : "unauthorized" } } } }.dump());
+            }
+            else if (action == "listen") {
+                if (!mAuthorized) {
+                    send(R"({"stream":"listening","data":{"error":"not authorized"}})");
+                    continue;
+                }
+                // {"action":"listen","data":{"streams":[...]}}; anything else listens to nothing.
+                nlohmann::json requested = nlohmann::json::array();
+                if (const auto data = msg.find("data"); data != msg.end() && data->is_object()) {
+                    if (const auto s = data->find("streams"); s != data->end() && s->is_array()) requested = *s;
+                }
+                nlohmann::json streams = nlohmann::json::array();
+                for (const auto& s : requested) {
+                    if (s == "trade_updates") {
+                        streams.push_back(s);
+                        if (!mListening) mServer.mListeners.push_back(weak_from_this());
+                        mListening = true;
+                    }
+                }
+                send(nlohmann::json{ { "stream", "listening" }, { "data", { { "streams", streams } } } }.dump());
+            }
+        }
+
+        mOutbox.clear();
+    }
+
+    void send(std::string iFrame)
+    {
+        mOutbox.push_back(std::move(iFrame));
+        if (mWriting) return;
+
+        mWriting = true;
+        asio::co_spawn(mWs.get_executor(), [self = shared_from_this()]() { return self->write_all(); }, asio::detached);
+    }
+
+private:
+
+    awaitable<void> write_all()
+    {
+        beast::error_code ec;
+        while (!mOutbox.empty()) {
+            co_await mWs.async_write(asio::buffer(mOutbox.front()), asio::redirect_error(use_awaitable, ec));
+            if (ec) {
+                mOutbox.clear();
+                break;
+            }
+            mOutbox.pop_front();
+        }
+        mWriting = false;
+    }
+
+    MockAlpacaServer& mServer;
+    ws::stream<beast::ssl_stream<beast::tcp_stream>> mWs;
+    std::deque<std::string> mOutbox;
+    bool mWriting = false;
+    bool mAuthorized = false;
+    bool mListening = false;
+};
+
+MockAlpacaServer::MockAlpacaServer(asio::any_io_executor iExecutor, Config iConfig)
+    : mExecutor(std::move(iExecutor)), mConfig(std::move(iConfig)), mTlsCtx(ssl::context::tls_server), mAcceptor(mExecutor)
+{
+    make_certificate();
+}
+
+MockAlpacaServer::~MockAlpacaServer() = default;
+
+void MockAlpacaServer::make_certificate()
+{
+    // P-256 keeps the handshake cheap; the certificate is valid for a week either side of now.
+    std::unique_ptr<EVP_PKEY, PkeyDeleter> key;
+    {
+        EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+        EVP_PKEY* raw = nullptr;
+        const bool ok = kctx && EVP_PKEY_keygen_init(kctx) > 0
+            && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) > 0
+            && EVP_PKEY_keygen(kctx, &raw) > 0;
+        EVP_PKEY_CTX_free(kctx);
+        if (!ok) throw_openssl("EVP_PKEY_keygen");
+        key.reset(raw);
+    }
+
+    std::unique_ptr<X509, X509Deleter> cert(X509_new());
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -7 * 24 * 3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 7 * 24 * 3600);
+    X509_set_pubkey(cert.get(), key.get());
+
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+
+    X509V3_CTX v3;
+    X509V3_set_ctx_nodb(&v3);
+    X509V3_set_ctx(&v3, cert.get(), cert.get(), nullptr, nullptr, 0);
+    for (const auto& [nid, value] : { std::pair{ NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1" },
+                                      std::pair{ NID_basic_constraints, "critical,CA:TRUE" } }) {
+        X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &v3, nid, value);
+        if (!ext) throw_openssl("X509V3_EXT_conf_nid");
+        X509_add_ext(cert.get(), ext, -1);
+        X509_EXTENSION_free(ext);
+    }
+
+    if (X509_sign(cert.get(), key.get(), EVP_sha256()) <= 0) throw_openssl("X509_sign");
+
+    mCertPem = to_pem([&](BIO* b) { return PEM_write_bio_X509(b, cert.get()) == 1; });
+    const std::string key_pem = to_pem([&](BIO* b) {
+        return PEM_write_bio_PrivateKey(b, key.get(), nullptr, nullptr, 0, nullptr, nullptr) == 1;
+        });
+
+    mTlsCtx.use_certificate_chain(asio::buffer(mCertPem));
+    mTlsCtx.use_private_key(asio::buffer(key_pem), ssl::context::pem);
+}
+
+void MockAlpacaServer::start()
+{
+    const tcp::endpoint endpoint(asio::ip::make_address(mConfig.address), mConfig.port);
+
+    mAcceptor.open(endpoint.protocol());
+    mAcceptor.set_option(asio::socket_base::reuse_address(true));
+    mAcceptor.bind(endpoint);
+    mAcceptor.listen(asio::socket_base::max_listen_connections);
+    mPort = mAcceptor.local_endpoint().port();
+
+    asio::co_spawn(mExecutor, accept_forever(), asio::detached);
+}
+
+void MockAlpacaServer::stop()
+{
+    beast::error_code ec;
+    mAcceptor.close(ec);
+}
+
+awaitable<void> MockAlpacaServer::accept_forever()
+{
+    for (;;) {
+        beast::error_code ec;
+        tcp::socket socket = co_await mAcceptor.async_accept(asio::redirect_error(use_awaitable, ec));
+        if (ec) {
+            if (!mAcceptor.is_open()) co_return;
+            continue;
+        }
+        socket.set_option(tcp::no_delay(true), ec);
+        asio::co_spawn(mExecutor, serve(std::move(socket)), asio::detached);
+    }
+}
+
+awaitable<void> MockAlpacaServer::serve(tcp::socket iSocket)
+{
+    beast::error_code ec;
+    beast::ssl_stream<beast::tcp_stream> stream(std::move(iSocket), mTlsCtx);
+    beast::get_lowest_layer(stream).expires_after(std::chrono::seconds(10));
+
+    co_await stream.async_handshake(ssl::stream_base::server, asio::redirect_error(use_awaitable, ec));
+    if (ec) co_return;
+    ++mStats.connections;
+
+    // Keep-alive loop. Pipelined requests sit in the buffer and are answered in order, each
+    // after its own delay, as a single-threaded upstream would.
+    beast::flat_buffer buffer;
+    asio::steady_timer delay(mExecutor);
+
+    for (;;) {
+        Request req;
+        beast::get_lowest_layer(stream).expires_never();
+        co_await http::async_read(stream, buffer, req, asio::redirect_error(use_awaitable, ec));
+        if (ec) break;
+
+        if (ws::is_upgrade(req)) {
+            if (req.target() != "/stream") {
+                co_await http::async_write(stream, make_error(req, http::status::not_found, 40410000, "endpoint not found"),
+                    asio::redirect_error(use_awaitable, ec));
+                break;
+            }
+            auto session = std::make_shared<StreamSession>(*this, std::move(stream));
+            co_await session->run(std::move(req));
+            co_return;
+        }
+
+        nlohmann::json accepted;
+        Response res = (req.method() == http::verb::post && req.target() == "/v2/orders")
+            ? post_order(req, accepted)
+            : handle(req);
+        if (res.result_int() >= 400) ++mStats.rejected;
+
+        delay.expires_after(next_delay());
+        co_await delay.async_wait(asio::redirect_error(use_awaitable, ec));
+
+        beast::get_lowest_layer(stream).expires_after(std::chrono::seconds(10));
+        co_await http::async_write(stream, res, asio::redirect_error(use_awaitable, ec));
+        if (ec) break;
+
+        // Fills only follow an ack the client has been sent.
+        if (!accepted.is_null()) schedule_fill(std::move(accepted));
+
+        if (!res.keep_alive()) break;
+    }
+
+    co_await stream.async_shutdown(asio::redirect_error(use_awaitable, ec));
+}
+
+Response MockAlpacaServer::handle(const Request& iReq)
+{
+    if (iReq[ "APCA-API-KEY-ID" ].empty() || iReq[ "APCA-API-SECRET-KEY" ].empty()) {
+        return make_error(iReq, http::status::unauthorized, 40110000, "request is not authorized");
+    }
+
+    if (iReq.method() == http::verb::get && iReq.target() == "/v2/account") {
+        return make_json(iReq, {
+            { "id", "00000000-0000-4000-8000-000000000000" },
+            { "account_number", "MOCK0000" },
+            { "status", "ACTIVE" },
+            { "currency", "USD" },
+            { "cash", money(mConfig.cash) },
+            { "equity", money(mConfig.cash) },
+            { "buying_power", money(mConfig.cash * 2.0) },
+            });
+    }
+
+    return make_error(iReq, http::status::not_found, 40410000, "endpoint not found");
+}
+
+Response MockAlpacaServer::post_order(const Request& iReq, nlohmann::json& accepted)
+{
+    if (iReq[ "APCA-API-KEY-ID" ].empty() || iReq[ "APCA-API-SECRET-KEY" ].empty()) {
+        return make_error(iReq, http::status::unauthorized, 40110000, "request is not authorized");
+    }
+
+    const nlohmann::json body = nlohmann::json::parse(iReq.body(), nullptr, false);
+    if (!body.is_object()) {
+        return make_error(iReq, http::status::bad_request, 40010000, "request body format is invalid");
+    }
+
+    // Fields of the wrong JSON type are a 422 like Alpaca's, not an exception that drops the
+    // connection.
+    const std::optional<std::string> symbol = string_field(body, "symbol");
+    const std::optional<std::string> side = string_field(body, "side");
+    const std::optional<std::string> type = string_field(body, "type", "market");
+    const std::optional<std::string> time_in_force = string_field(body, "time_in_force", "day");
+    const std::optional<std::string> client_order_id = string_field(body, "client_order_id");
+    const double qty = as_number(body.value("qty", nlohmann::json{}));
+
+    if (!symbol || symbol->empty()) return make_error(iReq, http::status::unprocessable_entity, 40010001, "symbol is required");
+    if (!side || (*side != "buy" && *side != "sell")) return make_error(iReq, http::status::unprocessable_entity, 40010001, "invalid side");
+    if (qty <= 0.0) return make_error(iReq, http::status::unprocessable_entity, 40010001, "qty must be > 0");
+    if (!type) return make_error(iReq, http::status::unprocessable_entity, 40010001, "invalid type");
+    if (!time_in_force) return make_error(iReq, http::status::unprocessable_entity, 40010001, "invalid time_in_force");
+    if (!client_order_id) return make_error(iReq, http::status::unprocessable_entity, 40010001, "invalid client_order_id");
+
+    char id[40];
+    std::snprintf(id, sizeof(id), "00000000-0000-4000-8000-%012llx", static_cast<unsigned long long>(++mOrderSeq));
+    ++mStats.orders;
+
+    const std::string now = utc_timestamp();
+    accepted = {
+        { "id", id },
+        { "client_order_id", client_order_id->empty() ? std::string(id) : *client_order_id },
+        { "created_at", now },
+        { "submitted_at", now },
+        { "symbol", *symbol },
+        { "asset_class", "us_equity" },
+        { "qty", body.at("qty").is_string() ? body.at("qty") : nlohmann::json(std::to_string(qty)) },
+        { "filled_qty", "0" },
+        { "filled_avg_price", nullptr },
+        { "type", *type },
+        { "side", *side },
+        { "time_in_force", *time_in_force },
+        { "limit_price", body.value("limit_price", nlohmann::json{}) },
+        { "status", "accepted" },
+    };
+    return make_json(iReq, accepted);
+}
+
+std::chrono::microseconds MockAlpacaServer::next_delay()
+{
+    if (mConfig.jitter.count() <= 0) return mConfig.latency;
+    std::uniform_int_distribution<long long> jitter(0, mConfig.jitter.count());
+    return mConfig.latency + std::chrono::microseconds(jitter(mRng));
+}
+
+void MockAlpacaServer::schedule_fill(nlohmann::json iOrder)
+{
+    iOrder["status"] = "new";
+    broadcast(nlohmann::json{ { "stream", "trade_updates" },
+        { "data", { { "event", "new" }, { "timestamp", utc_timestamp() }, { "order", iOrder } } } }.dump());
+
+    asio::co_spawn(mExecutor, [this, order = std::move(iOrder)]() mutable -> awaitable<void> {
+        asio::steady_timer t(mExecutor);
+        t.expires_after(mConfig.fill_delay);
+        co_await t.async_wait(use_awaitable);
+
+        const double qty = as_number(order["qty"]);
+        const double price = mConfig.fill_price;
+        mConfig.cash += (order["side"] == "buy") ? -qty * price : qty * price;
+
+        const std::string now = utc_timestamp();
+        order["status"] = "filled";
+        order["filled_qty"] = order["qty"];
+        order["filled_avg_price"] = money(price);
+        order["filled_at"] = now;
+
+        ++mStats.fills;
+        broadcast(nlohmann::json{ { "stream", "trade_updates" },
+            { "data", { { "event", "fill" }, { "timestamp", now }, { "price", money(price) },
+                        { "qty", order["qty"] }, { "order", order } } } }.dump());
+        }, asio::detached);
+}
+
+void MockAlpacaServer::broadcast(const std::string& iFrame)
+{
+    std::erase_if(mListeners, [&](const std::weak_ptr<StreamSession>& w) {
+        auto s = w.lock();
+        if (!s) return true;
+        s->send(iFrame);
+        return false;
+        });
+}
@@ -0,0 +1,192 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "OrderType.h"
+#include "FastQueue.hpp"
+#include "FastQueueMPSC.hpp"
+
+// N strategy threads submitting OrderMsg to one gateway thread:
+//   (a) one MpscFastQueue shared by all producers
+//   (b) N FastQueue SPSC rings, drained round-robin by the consumer
+// plus a framing check on a small MpscFastQueue with variable-size frames whose payload words
+// look like headers of nearby laps.
+
+using MpscQ = MpscFastQueue<(1u << 20), 8>;
+
+// Same ring size as the MPSC queue; producers spin (OverflowPolicy::SpinWait) when it is full.
+using SpscQ = FastQueue<(1u << 20), 8, (1u << 12)>;
+
+struct MpscRun {
+    double seconds = 0.0;
+    std::uint64_t consumed = 0;
+    std::uint64_t checksum = 0;
+};
+
+static inline void consume_order(const std::array<std::byte, 64>& buf, MpscRun& r) {
+    OrderMsg m;
+    std::memcpy(&m, buf.data(), sizeof(m));
+    r.checksum += (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
+    ++r.consumed;
+}
+
+static MpscRun run_mpsc(std::uint64_t per_producer, unsigned producers) {
+    MpscQ q;
+    auto consumer = q.make_consumer();
+    boost::barrier start(producers + 1);
+
+    std::vector<boost::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p, prod = q.make_producer()]() mutable {
+            pin_current_thread_to_cpu(p + 1);
+            start.wait();
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                const OrderMsg m = make_msg(i * producers + p, (i & 1) == 0);
+                prod.write(std::as_bytes(std::span{ &m, 1 }));
+            }
+            });
+    }
+
+    pin_current_thread_to_cpu(0);
+    MpscRun r;
+    std::array<std::byte, 64> buf{};
+    const std::uint64_t total = per_producer * producers;
+
+    start.wait();
+    const auto t0 = std::chrono::steady_clock::now();
+    while (r.consumed < total) {
+        if (consumer.try_read(buf) > 0) consume_order(buf, r);
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (auto& t : threads) t.join();
+    return r;
+}
+
+static MpscRun run_spsc_merged(std::uint64_t per_producer, unsigned producers) {
+    std::vector<std::unique_ptr<SpscQ>> queues;
+    std::vector<FastQueueConsumer<(1u << 20), 8, (1u << 12)>> consumers;
+    for (unsigned p = 0; p < producers; ++p) {
+        queues.push_back(std::make_unique<SpscQ>());
+        consumers.push_back(queues.back()->make_consumer());
+    }
+    boost::barrier start(producers + 1);
+
+    std::vector<boost::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p, prod = queues[p]->make_producer()]() mutable {
+            pin_current_thread_to_cpu(p + 1);
+            start.wait();
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                const OrderMsg m = make_msg(i * producers + p, (i & 1) == 0);
+                prod.write(std::as_bytes(std::span{ &m, 1 }));
+            }
+            });
+    }
+
+    pin_current_thread_to_cpu(0);
+    MpscRun r;
+    std::array<std::byte, 64> buf{};
+    const std::uint64_t total = per_producer * producers;
+
+    start.wait();
+    const auto t0 = std::chrono::steady_clock::now();
+    while (r.consumed < total) {
+        for (auto& c : consumers) {
+            if (c.try_read(buf) > 0) consume_order(buf, r);
+        }
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (auto& t : threads) t.join();
+    return r;
+}
+
+// Each frame: [u64 (producer << 48) | seq][words ((lap + k) << 32) | 8 ...], 8..104 bytes.
+// The consumer checks per-producer order and sizes; returns false on a bad frame or no progress.
+static bool check_mpsc_framing(std::uint64_t per_producer, unsigned producers) {
+    using SmallQ = MpscFastQueue<4096, 8>;
+    SmallQ q;
+    auto consumer = q.make_consumer();
+
+    auto frame_size = [](std::uint64_t i) { return std::size_t{ 8 } + 8 * (i % 13); };
+
+    std::atomic<bool> stop{ false };
+
+    std::vector<boost::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p, prod = q.make_producer()]() mutable {
+            std::uint64_t bytes = 0;            // rough guess of the queue position
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                const std::size_t size = frame_size(i);
+                const std::uint64_t lap = bytes / 4096 + 1;
+                auto fill = [&](std::span<std::byte> dst) {
+                    const std::uint64_t tag = (std::uint64_t(p) << 48) | i;
+                    std::memcpy(dst.data(), &tag, 8);
+                    for (std::size_t k = 1; k < size / 8; ++k) {
+                        const std::uint64_t w = ((lap + k % 3) << 32) | 8;
+                        std::memcpy(dst.data() + 8 * k, &w, 8);
+                    }
+                };
+                while (!prod.try_write_with(size, fill)) {
+                    if (stop.load(std::memory_order_relaxed)) return;
+                    cpu_relax();
+                }
+                bytes += (8 + size) * producers;
+            }
+            });
+    }
+
+    std::vector<std::uint64_t> expect(producers, 0);
+    std::array<std::byte, 128> buf{};
+    std::uint64_t consumed = 0;
+    bool ok = true;
+    auto last = std::chrono::steady_clock::now();
+
+    while (ok && consumed < per_producer * producers) {
+        const std::int32_t n = consumer.try_read(buf);
+        if (n <= 0) {
+            if (std::chrono::steady_clock::now() - last > std::chrono::seconds(5)) {
+                std::cout << "  stuck after " << consumed << " frames\n";
+                ok = false;
+            }
+            continue;
+        }
+        last = std::chrono::steady_clock::now();
+
+        std::uint64_t tag;
+        std::memcpy(&tag, buf.data(), 8);
+        const std::uint64_t p = tag >> 48, seq = tag & ((1ull << 48) - 1);
+        if (p >= producers || seq != expect[p] || std::size_t(n) != frame_size(seq)) {
+            std::cout << "  bad frame: producer " << p << " seq " << seq << " size " << n << "\n";
+            ok = false;
+            break;
+        }
+        ++expect[p];
+        ++consumed;
+    }
+
+    // A failed check may leave producers waiting on a full queue.
+    stop = true;
+    for (auto& t : threads) t.join();
+    return ok;
+}
+
+int run_mpsc_benchmark(std::uint64_t per_producer, unsigned max_producers)
+{
+    std::cout << "Messages/producer : " << per_producer << " (" << sizeof(OrderMsg) << " bytes)\n";
+    std::cout << "producers  mpsc msg/s     N x spsc msg/s   checksums\n";
+
+    for (unsigned producers = 1; producers <= max_producers; producers *= 2) {
+        const MpscRun a = run_mpsc(per_producer, producers);
+        const MpscRun b = run_spsc_merged(per_producer, producers);
+
+        std::cout << "  " << producers
+            << "        " << double(a.consumed) / a.seconds
+            << "     " << double(b.consumed) / b.seconds
+            << "     " << (a.checksum == b.checksum ? "match" : "MISMATCH") << "\n";
+    }
+
+    const bool framing = check_mpsc_framing(200'000, std::max(2u, max_producers));
+    std::cout << "Framing check     : " << (framing ? "PASS" : "FAIL") << "\n";
+    return framing ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "OrderManager.h"
+
+// ns per OMS operation with kOmsOpen orders alive at any time: every order is opened, then gets
+// new -> partial_fill -> fill (which closes it and frees its slot), interleaved across the open
+// set so the index always holds kOmsOpen entries. A foreign update (client_seq 0) and a late
+// fill for an already closed order are mixed in as well.
+
+using BenchOms = OrderManager<4096>;
+
+static constexpr std::uint64_t kOmsOpen = 1024;
+
+static TradeUpdateMsg make_update(std::uint64_t client_seq, TradeEvent event, double cum_qty) {
+    TradeUpdateMsg u{};
+    u.ts_recv = qpc_now();
+    u.client_seq = client_seq;
+    u.event = event;
+    u.fill_qty = 1.0;
+    u.fill_price = 100.0;
+    u.cum_qty = cum_qty;
+    u.avg_price = 100.0;
+    std::memcpy(u.order_id, "00000000-0000-4000-8000-000000000000", 37);
+    return u;
+}
+
+int run_oms_benchmark(std::uint64_t orders)
+{
+    BenchOms oms;
+    orders = std::max<std::uint64_t>(orders, kOmsOpen);
+
+    std::uint64_t filled = 0;
+    std::uint64_t ops = 0;
+
+    pin_current_thread_to_cpu(0);
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Order i is opened at step i and advanced one event per step until it fills at step
+    // i + kOmsOpen - 1, so kOmsOpen orders are in flight in the steady state.
+    for (std::uint64_t step = 0; step < orders + kOmsOpen; ++step) {
+        if (step < orders) {
+            OrderMsg m{};
+            m.ts_qpc = qpc_now();
+            m.seq = oms.next_seq();
+            m.symbol = static_cast<SymbolId>(m.seq % 64);
+            m.qty = 2;
+            m.action = Action::Buy;
+            oms.open(m);
+            ++ops;
+        }
+
+        const std::uint64_t base = step + 1;            // seqs start at 1
+        if (base > kOmsOpen / 2 && base - kOmsOpen / 2 <= orders) {
+            oms.apply(make_update(base - kOmsOpen / 2, TradeEvent::New, 0.0));
+            ++ops;
+        }
+        if (base > 3 * kOmsOpen / 4 && base - 3 * kOmsOpen / 4 <= orders) {
+            oms.apply(make_update(base - 3 * kOmsOpen / 4, TradeEvent::PartialFill, 1.0));
+            ++ops;
+        }
+        if (base > kOmsOpen && base - kOmsOpen <= orders) {
+            const OrderTransition t = oms.apply(make_update(base - kOmsOpen, TradeEvent::Fill, 2.0));
+            filled += (t.to == OrderState::Filled);
+            ++ops;
+        }
+        if ((step & 63) == 0) {
+            oms.apply(make_update(0, TradeEvent::Fill, 1.0));                    // not ours
+            if (base > kOmsOpen + 1) oms.apply(make_update(base - kOmsOpen - 1, TradeEvent::Fill, 2.0));   // already closed
+            ops += 2;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const BenchOms::Stats st = oms.stats();
+
+    std::cout << "Orders             : " << orders << " (" << kOmsOpen << " open at a time)\n";
+    std::cout << "Operations         : " << ops << ", " << (seconds * 1e9) / double(ops) << " ns/op, "
+        << double(ops) / seconds << " ops/s\n";
+    std::cout << "Filled             : " << filled << "\n";
+    std::cout << "Opened / closed    : " << st.opened << " / " << st.closed << ", still open " << st.open << "\n";
+    std::cout << "Untracked / illegal: " << st.untracked << " / " << st.illegal << "\n";
+
+    return (filled == orders && st.open == 0 && st.illegal == 0) ? 0 : 1;
+}
@@ -1,68 +1,74 @@
-
 #include "Porfolio.h"
+#include <cmath>
 
 
-Portfolio::Portfolio(const std::string& iName, const double& iCash, const std::string& iHost, const std::string& iPort) 
-    : mName(iName), mCash(iCash), mHost(iHost), mPort(iPort)
+Portfolio::Portfolio(const std::string& iName, const double& iCash, const std::string& iHost, const std::string& iPort)
+    : mName(iName), mHost(iHost), mPort(iPort), mTlsCtx(ssl::context::tls_client), mState(iCash, qpc_freq(), iName, &mQuotes)
 
 {
+    mTlsCtx.set_default_verify_paths();
+    mTlsCtx.set_verify_mode(ssl::verify_peer);
+
+    // Load root CAs (PEM bundle)
+    mTlsCtx.load_verify_file(CACERT_LOCATION);
+
+    mTlsCtx.set_verify_callback(ssl::host_name_verification(mHost));
+
     std::cout << "Creating account Portfolio: " << iName << " with cash: " << iCash << "\n" << std::endl;
 
 }
 
+void Portfolio::trust_certificate(std::string_view iPem) {
+    mTlsCtx.add_certificate_authority(asio::buffer(iPem.data(), iPem.size()));
+}
 
+asio::awaitable<void> Portfolio::start_rest_pool(std::size_t iConnections) {
+    if (mRestPool) co_return;
 
-awaitable<nlohmann::json> Portfolio::alpaca_get_account( ssl::context& tls_ctx) {
     auto ex = co_await asio::this_coro::executor;
-    beast::error_code ec;
-
-    // Resolve
-    tcp::resolver resolver(ex);
-    auto results = co_await resolver.async_resolve( mHost, mPort, asio::redirect_error(use_awaitable, ec));
-    if (ec) throw beast::system_error(ec, "resolve");
-
-    // TCP + TLS
-    beast::ssl_stream<beast::tcp_stream> tls_stream(ex, tls_ctx);
-
-    // SNI
-    if (!SSL_set_tlsext_host_name(tls_stream.native_handle(), mHost.c_str())) {
-        beast::error_code sni_ec(
-            static_cast<int>(::ERR_get_error()),
-            asio::error::get_ssl_category()
-        );
-        throw beast::system_error(sni_ec, "SNI");
-    }
 
-    co_await beast::get_lowest_layer(tls_stream).async_connect(
-        results, asio::redirect_error(use_awaitable, ec));
-    if (ec) throw beast::system_error(ec, "connect");
+    HttpsConnectionPool::Config config;
+    config.connections = iConnections;
 
-    co_await tls_stream.async_handshake(
-        ssl::stream_base::client, asio::redirect_error(use_awaitable, ec));
-    if (ec) throw beast::system_error(ec, "tls_handshake");
+    // Publish the pool before warming it so concurrent callers share it instead of building another.
+    mRestPool = std::make_unique<HttpsConnectionPool>(ex, mTlsCtx, mHost, mPort, config);
+    mRestScheduler = std::make_unique<RestScheduler>(ex, mRestLimit);
 
-    // Build HTTP request: GET /v2/account
-    http::request<http::string_body> req{ http::verb::get, "/v2/account", 11 };
+    asio::co_spawn(ex, mRestPool->maintain_forever(), asio::detached);
+
+    co_await mRestPool->warm_up();
+}
+
+void Portfolio::set_rest_rate_limit(const RestScheduler::Config& iConfig) {
+    mRestLimit = iConfig;
+    if (mRestScheduler) mRestScheduler->configure(iConfig);
+}
+
+HttpsConnectionPool::Request Portfolio::make_rest_request(http::verb iVerb, beast::string_view iTarget) const {
+    HttpsConnectionPool::Request req{ iVerb, iTarget, 11 };
     req.set(http::field::host, mHost);
     req.set(http::field::user_agent, "alpaca-rest-async/1.0");
     req.set(http::field::accept, "application/json");
+    req.keep_alive(true);
+
+    // Alpaca auth headers
     req.set("APCA-API-KEY-ID", APCA_KEY_ID);
     req.set("APCA-API-SECRET-KEY", APCA_SECRET);
+    return req;
+}
 
-    // Send request
-    co_await http::async_write(tls_stream, req, asio::redirect_error(use_awaitable, ec));
-    if (ec) throw beast::system_error(ec, "http_write");
+awaitable<nlohmann::json> Portfolio::alpaca_get_account() {
+    co_await start_rest_pool();
 
-    // Read response
-    beast::flat_buffer buffer;
-    http::response<http::string_body> res;
-    co_await http::async_read(tls_stream, buffer, res, asio::redirect_error(use_awaitable, ec));
-    if (ec) throw beast::system_error(ec, "http_read");
+    // A refresh already waiting for a token answers this call too.
+    co_return co_await mAccountRefresh.run(*mRestScheduler, RestPriority::Account, [this] { return fetch_account(); });
+}
 
-    // Graceful TLS shutdown (ignore EOF which is common on shutdown)
-    co_await tls_stream.async_shutdown(asio::redirect_error(use_awaitable, ec));
-    if (ec == asio::error::eof) ec = {};
-    // (Optional) if ec still set, log it; not always fatal.
+awaitable<nlohmann::json> Portfolio::fetch_account() {
+    // Build HTTP request: GET /v2/account
+    auto req = make_rest_request(http::verb::get, "/v2/account");
+
+    auto res = co_await mRestPool->request(req);
 
     if (res.result() != http::status::ok) {
         throw std::runtime_error("GET /v2/account failed: HTTP " + std::to_string(res.result_int())
@@ -72,106 +78,161 @@ awaitable<nlohmann::json> Portfolio::alpaca_get_account( ssl::context& tls_ctx)
     co_return nlohmann::json::parse(res.body());
 }
 
- asio::awaitable<void> Portfolio::poll_account_forever() {
-     
-    ssl::context tls_ctx(ssl::context::tls_client);
-    tls_ctx.set_default_verify_paths();
-    tls_ctx.set_verify_mode(ssl::verify_peer);
+ asio::awaitable<AccountDrift> Portfolio::reconcile_account() {
 
-    // Load root CAs (PEM bundle)
-    tls_ctx.load_verify_file(CACERT_LOCATION);
+    auto account = co_await alpaca_get_account();
+
+    const double cash = std::stod(account.value("cash", "0"));
+    const double bp = std::stod(account.value("buying_power", "0"));
+    co_return mState.reconcile_account(cash, bp);
+}
 
-    tls_ctx.set_verify_callback(ssl::host_name_verification(mHost));
+ asio::awaitable<void> Portfolio::reconcile_account_forever(std::chrono::seconds iPeriod) {
 
     auto ex = co_await asio::this_coro::executor;
     asio::steady_timer t(ex);
 
-    while(true) 
+    while(true)
     {
-        try 
+        try
         {
-            auto account = co_await alpaca_get_account(tls_ctx);
-
-            const std::string equity = account.value("equity", "0");
-            const std::string cash = account.value("cash", "0");
-            const std::string bp = account.value("buying_power", "0");
-
-            std::cout << "equity=" << equity
-                << " cash=" << cash
-                << " buying_power=" << bp << "\n";
-
-            mCash = std::stod(cash);
+            const AccountDrift drift = co_await reconcile_account();
+
+            std::cout << "cash=" << mState.cash()
+                << " buying_power=" << mState.buying_power()
+                << " drift cash=" << drift.cash
+                << " buying_power=" << drift.buying_power
+                << " (max " << drift.max_abs_cash << " / " << drift.max_abs_buying_power
+                << " over " << drift.reconciliations << ")\n";
         }
         catch (const std::exception& e) {
-            std::cerr << "[account poll error] " << e.what() << "\n";
+            std::cerr << "[account reconcile error] " << e.what() << "\n";
         }
 
-        t.expires_after(std::chrono::seconds(10));
+        t.expires_after(iPeriod);
         co_await t.async_wait(use_awaitable);
     }
 }
 
- awaitable<nlohmann::json> Portfolio::alpaca_post_order( const nlohmann::json& order, ssl::context& tls_ctx)
+ // "3", 3, or 0 when absent / null.
+ static double json_number(const nlohmann::json& o, const char* key)
  {
-     auto ex = co_await asio::this_coro::executor;
-     beast::error_code ec;
-
-     // Resolve
-     tcp::resolver resolver(ex);
-     auto results = co_await resolver.async_resolve( mHost, mPort, asio::redirect_error(use_awaitable, ec));
-     if (ec) throw beast::system_error(ec, "resolve");
-
-     // TCP + TLS
-     beast::ssl_stream<beast::tcp_stream> tls_stream(ex, tls_ctx);
-
-     // SNI (important)
-     if (!SSL_set_tlsext_host_name(tls_stream.native_handle(), mHost.c_str())) {
-         beast::error_code sni_ec(
-             static_cast<int>(::ERR_get_error()),
-             asio::error::get_ssl_category()
-         );
-         throw beast::system_error(sni_ec, "SNI");
+     const auto it = o.find(key);
+     if (it == o.end() || it->is_null()) return 0.0;
+     return it->is_string() ? std::stod(it->get<std::string>()) : it->get<double>();
+ }
+
+ std::uint64_t Portfolio::admit_order(nlohmann::json& ioOrder)
+ {
+     const double qty = json_number(ioOrder, "qty");
+     if (!(qty > 0.0)) throw std::runtime_error("POST /v2/orders blocked: order has no qty");
+
+     const SymbolId symbol = SymbolTable::getInstance().intern(ioOrder.value("symbol", ""));
+     const Action side = (ioOrder.value("side", "") == "sell") ? Action::Sell : Action::Buy;
+     const double limit = json_number(ioOrder, "limit_price");
+
+     OrderMsg m = mState.make_order(symbol, side, static_cast<std::uint32_t>(std::ceil(qty)), qpc_now());
+     if (const std::uint32_t reject = mState.risk_check(m, m.ts_qpc, limit)) {
+         throw std::runtime_error(std::string("POST /v2/orders blocked by risk: ") + risk_reject_reason(reject));
      }
 
-     co_await beast::get_lowest_layer(tls_stream).async_connect(
-         results, asio::redirect_error(use_awaitable, ec));
-     if (ec) throw beast::system_error(ec, "connect");
+     // Caller-named orders cannot be matched back to a seq, so only ours are tracked.
+     if (ioOrder.contains("client_order_id")) return 0;
+     if (!mState.orders().open(m, limit)) {
+         throw std::runtime_error("POST /v2/orders not sent: OMS pool full");
+     }
+     ioOrder["client_order_id"] = mState.orders().client_order_id(m.seq);
+     return m.seq;
+ }
 
-     co_await tls_stream.async_handshake(
-         ssl::stream_base::client, asio::redirect_error(use_awaitable, ec));
-     if (ec) throw beast::system_error(ec, "tls_handshake");
+ awaitable<nlohmann::json> Portfolio::alpaca_post_order( const nlohmann::json& order)
+ {
+     nlohmann::json body = order;
+     const std::uint64_t seq = admit_order(body);
 
-     // Build HTTP request: POST /v2/orders
-     http::request<http::string_body> req{ http::verb::post, "/v2/orders", 11 };
-     req.set(http::field::host, mHost);
-     req.set(http::field::user_agent, "alpaca-rest-async/1.0");
-     req.set(http::field::accept, "application/json");
-     req.set(http::field::content_type, "application/json");
+     HttpsConnectionPool::Response res;
+     try {
+         co_await start_rest_pool();
+         co_await mRestScheduler->acquire(RestPriority::Order);
 
-     // Alpaca auth headers
-     req.set("APCA-API-KEY-ID", APCA_KEY_ID);
-     req.set("APCA-API-SECRET-KEY", APCA_SECRET);
+         // Build HTTP request: POST /v2/orders
+         auto req = make_rest_request(http::verb::post, "/v2/orders");
+         req.set(http::field::content_type, "application/json");
 
-     req.body() = order.dump();
-     req.prepare_payload();
+         req.body() = body.dump();
+         req.prepare_payload();
 
-     // Send request
-     co_await http::async_write(tls_stream, req, asio::redirect_error(use_awaitable, ec));
-     if (ec) throw beast::system_error(ec, "http_write");
+         // One write + one read on an already-open socket
+         res = co_await mRestPool->request(req);
+     }
+     catch (...) {
+         if (seq) mState.orders().send_failed(seq);
+         throw;
+     }
 
-     // Read response
-     beast::flat_buffer buffer;
-     http::response<http::string_body> res;
+     if (res.result() != http::status::ok) {
+         if (seq) mState.orders().send_failed(seq);
+         throw std::runtime_error(
+             "POST /v2/orders failed: HTTP " + std::to_string(res.result_int()) +
+             " body=" + res.body()
+         );
+     }
+
+     co_return nlohmann::json::parse(res.body());
+ }
 
-     co_await http::async_read(tls_stream, buffer, res, asio::redirect_error(use_awaitable, ec));
+ awaitable<nlohmann::json> Portfolio::alpaca_post_order( const OrderMsg& order, LatencyTracer* iTracer)
+ {
+     if (const std::uint32_t reject = mState.risk_check(order, qpc_now())) {
+         throw std::runtime_error(std::string("POST /v2/orders blocked by risk: ") + risk_reject_reason(reject));
+     }
+     if (!mState.orders().open(order)) {
+         throw std::runtime_error("POST /v2/orders not sent: client seq " + std::to_string(order.seq) + " already open or OMS pool full");
+     }
 
-     if (ec) throw beast::system_error(ec, "http_read");
+     try {
+         co_await start_rest_pool();
+         // Throttled orders queue here, already counted by risk and the OMS.
+         if (!mRestScheduler->try_acquire(RestPriority::Order)) co_await mRestScheduler->acquire(RestPriority::Order);
+     }
+     catch (...) {
+         mState.orders().send_failed(order.seq);
+         throw;
+     }
 
-     // Shutdown TLS (EOF is common here)
-     co_await tls_stream.async_shutdown(asio::redirect_error(use_awaitable, ec));
-     if (ec == asio::error::eof) ec = {};
+     std::unique_ptr<OrderSerializer> serializer;
+     HttpsConnectionPool::Response res;
+     try
+     {
+         if (mSerializers.empty()) {
+             serializer = std::make_unique<OrderSerializer>(mHost, APCA_KEY_ID, APCA_SECRET, mState.orders().id_prefix());
+         }
+         else {
+             serializer = std::move(mSerializers.back());
+             mSerializers.pop_back();
+         }
+
+         const std::string_view wire = serializer->serialize(order);
+         std::uint64_t written_at = 0;
+         if (iTracer) iTracer->stamp(order.seq, TraceStage::Serialized);
+
+         res = co_await mRestPool->request_raw(wire, false, iTracer ? &written_at : nullptr);
+
+         if (iTracer) {
+             iTracer->stamp(order.seq, TraceStage::Written, written_at);
+             iTracer->stamp(order.seq, TraceStage::Acked);
+             iTracer->complete(order.seq);
+         }
+     }
+     catch (...) {
+         if (serializer) mSerializers.push_back(std::move(serializer));
+         mState.orders().send_failed(order.seq);
+         throw;
+     }
+     mSerializers.push_back(std::move(serializer));
 
      if (res.result() != http::status::ok) {
+         mState.orders().send_failed(order.seq);
          throw std::runtime_error(
              "POST /v2/orders failed: HTTP " + std::to_string(res.result_int()) +
              " body=" + res.body()
@@ -179,4 +240,110 @@ awaitable<nlohmann::json> Portfolio::alpaca_get_account( ssl::context& tls_ctx)
      }
 
      co_return nlohmann::json::parse(res.body());
- }
\ No newline at end of file
+ }
+
+ awaitable<void> Portfolio::alpaca_cancel_order(std::uint64_t iClientSeq)
+ {
+     OrderRecord o;
+     if (!mState.orders().lookup(iClientSeq, o)) {
+         throw std::runtime_error("DELETE /v2/orders: client seq " + std::to_string(iClientSeq) + " is not open");
+     }
+     if (o.order_id[0] == '\0') {
+         throw std::runtime_error("DELETE /v2/orders: client seq " + std::to_string(iClientSeq) + " not acknowledged yet");
+     }
+
+     co_await start_rest_pool();
+     co_await mRestScheduler->acquire(RestPriority::Cancel);
+
+     const std::string target = std::string("/v2/orders/") + o.order_id;
+     auto req = make_rest_request(http::verb::delete_, target);
+
+     auto res = co_await mRestPool->request(req);
+
+     if (res.result() != http::status::no_content && res.result() != http::status::ok) {
+         throw std::runtime_error("DELETE " + target + " failed: HTTP " + std::to_string(res.result_int())
+             + " body=" + res.body());
+     }
+ }
+
+ awaitable<std::vector<OrderAck>> Portfolio::alpaca_post_orders(std::span<const nlohmann::json> orders, std::size_t iWindow)
+ {
+     co_await start_rest_pool();
+
+     std::vector<OrderAck> acks(orders.size());
+     std::vector<std::uint64_t> seqs(orders.size(), 0);     // OMS seq, 0 when not tracked
+     std::vector<std::size_t> sent;                          // acks index of each request
+     std::vector<HttpsConnectionPool::Request> reqs;
+     reqs.reserve(orders.size());
+
+     for (std::size_t i = 0; i < orders.size(); ++i) {
+         nlohmann::json body = orders[i];
+         try {
+             seqs[i] = admit_order(body);
+         }
+         catch (const std::exception& e) {
+             acks[i].client_order_id = body.value("client_order_id", "");
+             acks[i].error = e.what();
+             continue;
+         }
+         acks[i].client_order_id = body["client_order_id"].get<std::string>();
+
+         auto req = make_rest_request(http::verb::post, "/v2/orders");
+         req.set(http::field::content_type, "application/json");
+         req.body() = body.dump();
+         req.prepare_payload();
+
+         reqs.push_back(std::move(req));
+         sent.push_back(i);
+     }
+
+     // One token per order; the burst goes out once the budget covers all of it.
+     for (std::size_t i = 0; i < reqs.size(); ++i) co_await mRestScheduler->acquire(RestPriority::Order);
+
+     auto results = co_await mRestPool->pipeline(reqs, iWindow);
+
+     // Pipelined responses come back in send order; the id check catches a misbehaving proxy.
+     std::unordered_map<std::string, std::size_t> by_id;
+
+     for (std::size_t k = 0; k < results.size(); ++k) {
+         auto& r = results[k];
+         const std::size_t i = sent[k];
+         if (r.ec) {
+             acks[i].error = r.ec.message();
+             if (seqs[i]) mState.orders().send_failed(seqs[i]);
+             continue;
+         }
+
+         nlohmann::json body = nlohmann::json::parse(r.response.body(), nullptr, false);
+         std::size_t slot = i;
+
+         if (body.is_object()) {
+             const std::string id = body.value("client_order_id", acks[i].client_order_id);
+             if (id != acks[i].client_order_id) {
+                 if (by_id.empty()) {
+                     for (std::size_t j : sent) by_id.emplace(acks[j].client_order_id, j);
+                 }
+                 auto it = by_id.find(id);
+                 if (it == by_id.end()) {
+                     acks[i].error = "response for unknown client_order_id " + id;
+                     continue;
+                 }
+                 slot = it->second;
+             }
+         }
+
+         acks[slot].http_status = r.response.result_int();
+         if (!acks[slot].ok()) {
+             acks[slot].error = r.response.body();
+             if (seqs[slot]) mState.orders().send_failed(seqs[slot]);
+         }
+         acks[slot].body = std::move(body);
+     }
+
+     // A response moved to another slot leaves its own slot unanswered.
+     for (auto& ack : acks) {
+         if (ack.http_status == 0 && ack.error.empty()) ack.error = "no response matched client_order_id " + ack.client_order_id;
+     }
+
+     co_return acks;
+ }
@@ -0,0 +1,126 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "MarketDataPipeline.h"
+#include "TradeUpdatePipeline.h"
+#include <random>
+
+// One writer decoding synthetic stocks-stream quote frames into a QuoteCache while reader
+// threads snapshot random symbols. Every quote carries a single counter n in all four fields
+// (bp = n + 0.5, ap = n + 1.5, bs = as = n), so a snapshot mixing two updates is detected.
+
+using BenchQuoteCache = QuoteCache<1024>;
+
+static constexpr std::size_t kQuoteSymbols = 512;
+static constexpr std::size_t kQuotesPerFrame = 8;
+static constexpr std::size_t kQuoteFrames = 4096;
+
+struct QuoteReaderRun {
+    std::uint64_t reads = 0;
+    std::uint64_t retries = 0;
+    std::uint64_t torn = 0;
+    double seconds = 0.0;
+};
+
+static std::string symbol_name(std::size_t i) {
+    std::string s = "S";
+    s += std::to_string(i);
+    return s;
+}
+
+static std::vector<std::string> make_quote_frames() {
+    std::vector<std::string> frames;
+    frames.reserve(kQuoteFrames);
+
+    std::uint64_t n = 1;
+    for (std::size_t f = 0; f < kQuoteFrames; ++f) {
+        std::string frame = "[";
+        for (std::size_t k = 0; k < kQuotesPerFrame; ++k, ++n) {
+            if (k) frame += ",";
+            const std::string sym = symbol_name((f * kQuotesPerFrame + k) % kQuoteSymbols);
+            frame += R"({"T":"q","S":")" + sym + R"(","bx":"V","bp":)" + std::to_string(n) + ".5"
+                + R"(,"bs":)" + std::to_string(n) + R"(,"ax":"V","ap":)" + std::to_string(n + 1) + ".5"
+                + R"(,"as":)" + std::to_string(n) + R"(,"c":["R"],"z":"C","t":"2026-01-05T14:30:00.123456789Z"})";
+        }
+        frame += "]";
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+static bool consistent(const Quote& q) {
+    if (q.version == 0) return true;        // never written
+    return q.bid_size == q.ask_size
+        && static_cast<std::uint32_t>(q.bid_price) == q.bid_size
+        && static_cast<std::uint32_t>(q.ask_price) == q.bid_size + 1;
+}
+
+int run_quote_cache_benchmark(std::uint64_t messages, unsigned readers)
+{
+    const std::uint64_t freq = qpc_freq();
+
+    // Interned in order, so the ids are 0 .. kQuoteSymbols-1.
+    SymbolTable symbols;
+    for (std::size_t i = 0; i < kQuoteSymbols; ++i) symbols.intern(symbol_name(i));
+
+    BenchQuoteCache cache;
+    MarketDataPublisher<BenchQuoteCache> publisher(cache, freq, symbols);
+    const std::vector<std::string> frames = make_quote_frames();
+
+    std::atomic<bool> done{ false };
+    boost::barrier start(readers + 1);
+    std::vector<QuoteReaderRun> runs(readers);
+
+    std::vector<boost::thread> threads;
+    for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            pin_current_thread_to_cpu(r + 1);
+            std::minstd_rand rng(r + 1);
+            QuoteReaderRun& run = runs[r];
+            Quote q;
+
+            start.wait();
+            const auto t0 = std::chrono::steady_clock::now();
+            while (!done.load(std::memory_order_relaxed)) {
+                run.retries += cache.read(static_cast<SymbolId>(rng() % kQuoteSymbols), q);
+                if (!consistent(q)) ++run.torn;
+                ++run.reads;
+            }
+            run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            });
+    }
+
+    pin_current_thread_to_cpu(0);
+    const std::uint64_t frame_count = std::max<std::uint64_t>(messages / kQuotesPerFrame, 1);
+    std::uint64_t published = 0;
+
+    start.wait();
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t f = 0; f < frame_count; ++f) {
+        published += publisher.publish_frame(frames[f % frames.size()], qpc_now());
+    }
+    const double writer_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    done.store(true, std::memory_order_relaxed);
+    for (auto& t : threads) t.join();
+
+    QuoteReaderRun total;
+    for (const auto& run : runs) {
+        total.reads += run.reads;
+        total.retries += run.retries;
+        total.torn += run.torn;
+        total.seconds += run.seconds;
+    }
+
+    std::cout << "Symbols            : " << symbols.size() << " (" << kQuotesPerFrame << " quotes/frame)\n";
+    std::cout << "Writer             : " << published << " quotes, " << (writer_s * 1e9) / double(published) << " ns/quote (decode + publish)\n";
+    print_stage("publish    ", publisher.stats().publish);
+    std::cout << "Readers            : " << readers << "\n";
+    if (total.reads > 0) {
+        std::cout << "Reads              : " << total.reads << ", " << (total.seconds * 1e9) / double(total.reads) << " ns/read\n";
+        std::cout << "Retries            : " << total.retries << " (" << 100.0 * double(total.retries) / double(total.reads) << "% of reads)\n";
+    }
+    std::cout << "Torn snapshots     : " << total.torn << "\n";
+
+    return total.torn == 0 ? 0 : 1;
+}
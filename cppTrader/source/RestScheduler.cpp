@@ -0,0 +1,126 @@
+#include "RestScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+
+RestScheduler::RestScheduler(asio::any_io_executor iExecutor, Config iConfig)
+    : mExecutor(std::move(iExecutor)), mLast(std::chrono::steady_clock::now()), mRefill(mExecutor), mAlive(std::make_shared<bool>(true))
+{
+    configure(iConfig);
+    mTokens = mConfig.burst;
+}
+
+void RestScheduler::configure(Config iConfig) {
+    const auto now = std::chrono::steady_clock::now();
+    refill(now);
+
+    mConfig = iConfig;
+    mConfig.burst = std::max(mConfig.burst, 1.0);
+    mTokensPerNs = mConfig.requests_per_minute / 60e9;
+    mTokens = std::min(mTokens, mConfig.burst);
+
+    // A higher rate may already cover queued requests; a pending refill timer keeps its old expiry.
+    pump();
+}
+
+void RestScheduler::refill(std::chrono::steady_clock::time_point now) {
+    const double ns = std::chrono::duration<double, std::nano>(now - mLast).count();
+    mTokens = std::min(mConfig.burst, mTokens + ns * mTokensPerNs);
+    mLast = now;
+}
+
+void RestScheduler::grant(RestPriority p, std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now) {
+    mTokens -= 1.0;
+    ClassStats& s = mStats[index(p)];
+    ++s.granted;
+    s.delay.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count()));
+}
+
+bool RestScheduler::try_acquire(RestPriority p) {
+    if (mQueued != 0) return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    refill(now);
+    if (mTokens < 1.0) return false;
+
+    grant(p, now, now);
+    ++mStats[index(p)].immediate;
+    return true;
+}
+
+awaitable<void> RestScheduler::acquire(RestPriority p) {
+    if (try_acquire(p)) co_return;
+
+    Waiter w{ asio::steady_timer(mExecutor, std::chrono::steady_clock::time_point::max()), std::chrono::steady_clock::now() };
+
+    ClassStats& s = mStats[index(p)];
+    mWaiters[index(p)].push_back(&w);
+    ++mQueued;
+    s.max_queued = std::max(s.max_queued, ++s.queued);
+
+    // Leaves the queue if this coroutine is destroyed before its grant (io_context stopped).
+    struct Withdraw {
+        RestScheduler& scheduler;
+        RestPriority p;
+        Waiter& w;
+        ~Withdraw() { if (!w.granted) scheduler.withdraw(p, w); }
+    } withdraw{ *this, p, w };
+
+    pump();
+
+    while (!w.granted) {
+        beast::error_code ec;
+        co_await w.wake.async_wait(asio::redirect_error(use_awaitable, ec));
+    }
+}
+
+void RestScheduler::withdraw(RestPriority p, Waiter& w) {
+    auto& q = mWaiters[index(p)];
+    auto it = std::find(q.begin(), q.end(), &w);
+    if (it == q.end()) return;
+
+    q.erase(it);
+    --mQueued;
+    --mStats[index(p)].queued;
+}
+
+void RestScheduler::pump() {
+    if (mQueued == 0) return;
+
+    const auto now = std::chrono::steady_clock::now();
+    refill(now);
+
+    // Strict priority: a lower class only gets a token when every higher class is empty.
+    for (std::size_t c = 0; c < kRestPriorities && mTokens >= 1.0; ) {
+        auto& q = mWaiters[c];
+        if (q.empty()) {
+            ++c;
+            continue;
+        }
+
+        Waiter* w = q.front();
+        q.pop_front();
+        --mQueued;
+        --mStats[c].queued;
+
+        grant(static_cast<RestPriority>(c), w->queued_at, now);
+        w->granted = true;
+        w->wake.cancel();
+    }
+
+    if (mQueued != 0) arm_refill();
+}
+
+void RestScheduler::arm_refill() {
+    if (mRefillArmed || mTokensPerNs <= 0.0) return;
+
+    const double wait_ns = std::max(0.0, (1.0 - mTokens) / mTokensPerNs);
+    mRefill.expires_after(std::chrono::nanoseconds(static_cast<std::int64_t>(std::ceil(wait_ns))));
+    mRefillArmed = true;
+
+    mRefill.async_wait([this, alive = std::weak_ptr<bool>(mAlive)](const beast::error_code&) {
+        if (alive.expired()) return;
+        mRefillArmed = false;
+        pump();
+        });
+}
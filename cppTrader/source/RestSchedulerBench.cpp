@@ -0,0 +1,82 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "RestScheduler.h"
+#include "TradeUpdatePipeline.h"
+
+// RestScheduler under a synthetic overload, no network: kSchedOrders orders and kSchedPolls
+// account refreshes arrive at once against a budget of kSchedPerMinute requests/minute, then
+// kSchedCancels cancels arrive while the orders are still queued. Checks that the cancels jump
+// every queued order, the account refresh goes last, and all but one refresh coalesce.
+
+static constexpr std::size_t kSchedOrders = 40;
+static constexpr std::size_t kSchedPolls = 40;
+static constexpr std::size_t kSchedCancels = 10;
+static constexpr double kSchedPerMinute = 6000.0;       // one token every 10 ms
+static constexpr double kSchedBurst = 5.0;
+
+int run_rest_scheduler_benchmark()
+{
+    asio::io_context ioc;
+    RestScheduler sched(ioc.get_executor(), { kSchedPerMinute, kSchedBurst });
+    CoalescedRequest<int> refresh;
+
+    std::vector<RestPriority> grants;                   // grant order, as the requests resume
+    std::size_t polls_answered = 0;
+
+    auto request = [&](RestPriority p) -> awaitable<void> {
+        co_await sched.acquire(p);
+        grants.push_back(p);
+    };
+    auto poll = [&]() -> awaitable<void> {
+        polls_answered += co_await refresh.run(sched, RestPriority::Account, [&]() -> awaitable<int> {
+            grants.push_back(RestPriority::Account);
+            co_return 1;
+            }) > 0;
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kSchedOrders; ++i) asio::co_spawn(ioc, request(RestPriority::Order), asio::detached);
+    for (std::size_t i = 0; i < kSchedPolls; ++i) asio::co_spawn(ioc, poll(), asio::detached);
+
+    asio::steady_timer later(ioc, std::chrono::milliseconds(50));
+    later.async_wait([&](const beast::error_code&) {
+        for (std::size_t i = 0; i < kSchedCancels; ++i) asio::co_spawn(ioc, request(RestPriority::Cancel), asio::detached);
+        });
+
+    ioc.run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // Position of the last cancel and of the first order after the first cancel.
+    std::size_t first_cancel = grants.size(), last_cancel = 0, last_order = 0;
+    for (std::size_t i = 0; i < grants.size(); ++i) {
+        if (grants[i] == RestPriority::Cancel) {
+            first_cancel = std::min(first_cancel, i);
+            last_cancel = i;
+        }
+        if (grants[i] == RestPriority::Order) last_order = i;
+    }
+    std::size_t orders_jumped = 0;                      // orders granted between the first and last cancel
+    for (std::size_t i = first_cancel; i < last_cancel; ++i) orders_jumped += (grants[i] == RestPriority::Order);
+
+    std::cout << "Budget             : " << kSchedPerMinute << " req/min, burst " << kSchedBurst << "\n";
+    std::cout << "Requests           : " << kSchedOrders << " orders + " << kSchedPolls << " account polls at t=0, "
+        << kSchedCancels << " cancels at t=50ms, " << seconds << " s\n";
+    for (RestPriority p : { RestPriority::Cancel, RestPriority::Order, RestPriority::Account }) {
+        const RestScheduler::ClassStats& st = sched.stats(p);
+        std::cout << "  " << rest_priority_name(p) << ": " << st.granted << " granted, " << st.immediate << " immediate, "
+            << st.coalesced << " coalesced, max queued " << st.max_queued << "\n";
+        print_stage("delay      ", st.delay);
+    }
+
+    const RestScheduler::ClassStats& acct = sched.stats(RestPriority::Account);
+    const bool pass = orders_jumped == 0
+        && last_cancel < last_order
+        && grants.back() == RestPriority::Account
+        && acct.granted == 1 && acct.coalesced == kSchedPolls - 1
+        && polls_answered == kSchedPolls;
+    std::cout << "Priority / coalesce: " << orders_jumped << " orders between cancels, account "
+        << (grants.back() == RestPriority::Account ? "last" : "not last") << ", " << polls_answered << " polls answered "
+        << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
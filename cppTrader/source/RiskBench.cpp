@@ -0,0 +1,104 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "RiskGate.h"
+#include "TradeUpdatePipeline.h"
+
+// ns/order of RiskGate::check on the order path (clock read included), first alone, then while
+// a control thread keeps rewriting every symbol's limits. Orders rotate over kRiskSymbols ids;
+// one in 16 is oversized so the reject path is exercised too. Per-order latency is sampled by
+// timing blocks of kRiskBlock checks.
+
+using BenchRiskGate = RiskGate<1024>;
+
+static constexpr std::size_t kRiskSymbols = 256;
+static constexpr std::size_t kRiskOrders = 4096;
+static constexpr std::uint64_t kRiskBlock = 16;
+static constexpr double kRiskTargetNs = 100.0;
+
+struct RiskRun {
+    double ns_per_check = 0.0;
+    std::uint64_t rejected = 0;
+    std::uint32_t reasons = 0;          // OR of every reject mask
+    HdrHistogram per_check;
+};
+
+static std::vector<OrderMsg> make_risk_orders() {
+    std::vector<OrderMsg> orders(kRiskOrders);
+    for (std::size_t i = 0; i < kRiskOrders; ++i) {
+        OrderMsg& m = orders[i];
+        m.seq = i + 1;
+        m.symbol = static_cast<SymbolId>((i * 7) % kRiskSymbols);
+        m.action = (i & 1) ? Action::Sell : Action::Buy;
+        m.qty = (i % 16 == 15) ? 50'000u : 1u + std::uint32_t(i % 10);
+    }
+    return orders;
+}
+
+static RiskRun time_checks(BenchRiskGate& gate, const std::vector<OrderMsg>& orders, std::uint64_t iterations, std::uint64_t freq) {
+    RiskRun run;
+    const std::uint64_t rejected0 = gate.stats().rejected;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; i += kRiskBlock) {
+        const std::uint64_t b0 = TscClock::now();
+        for (std::uint64_t k = 0; k < kRiskBlock; ++k) {
+            const OrderMsg& m = orders[(i + k) & (kRiskOrders - 1)];
+            run.reasons |= gate.check(m, 100.0 + double(m.symbol), 1e9, TscClock::now());
+        }
+        run.per_check.add(ticks_to_ns(TscClock::now() - b0, freq) / kRiskBlock);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    run.ns_per_check = std::chrono::duration<double, std::nano>(t1 - t0).count() / double(iterations);
+    run.rejected = gate.stats().rejected - rejected0;
+    return run;
+}
+
+int run_risk_benchmark(std::uint64_t iterations)
+{
+    const std::uint64_t freq = qpc_freq();
+    iterations = std::max<std::uint64_t>(iterations / kRiskBlock, 1) * kRiskBlock;
+
+    // Rate limit high enough that only qty rejects: this measures the checks, not the throttle.
+    RiskLimits limits;
+    limits.max_qty = 10'000;
+    limits.max_notional = 5'000'000.0;
+    limits.orders_per_sec = 1e9;
+    limits.burst = 1e6;
+
+    BenchRiskGate gate(freq, limits);
+    const std::vector<OrderMsg> orders = make_risk_orders();
+
+    pin_current_thread_to_cpu(0);
+    time_checks(gate, orders, std::min<std::uint64_t>(iterations, 1'000'000), freq);   // warm up
+    const RiskRun quiet = time_checks(gate, orders, iterations, freq);
+
+    // Same again while limits are reloaded as fast as one thread can.
+    std::atomic<bool> done{ false };
+    std::uint64_t reloads = 0;
+    boost::thread reloader([&] {
+        pin_current_thread_to_cpu(1);
+        RiskLimits l = limits;
+        while (!done.load(std::memory_order_relaxed)) {
+            for (SymbolId id = 0; id < kRiskSymbols; ++id) {
+                l.max_notional = (reloads & 1) ? 5'000'000.0 : 4'000'000.0;
+                gate.set_limits(id, l);
+            }
+            ++reloads;
+        }
+        });
+    const RiskRun reloading = time_checks(gate, orders, iterations, freq);
+    done.store(true, std::memory_order_relaxed);
+    reloader.join();
+
+    std::cout << "Checks             : " << iterations << " per run over " << kRiskSymbols << " symbols (1/16 oversized)\n";
+    std::cout << "Quiet              : " << quiet.ns_per_check << " ns/check, " << quiet.rejected << " rejected (" << risk_reject_reason(quiet.reasons) << ")\n";
+    print_stage("per check  ", quiet.per_check);
+    std::cout << "Reloading          : " << reloading.ns_per_check << " ns/check, " << reloads << " full reloads during the run\n";
+    print_stage("per check  ", reloading.per_check);
+
+    const bool pass = quiet.ns_per_check < kRiskTargetNs && reloading.ns_per_check < kRiskTargetNs;
+    std::cout << "Target             : < " << kRiskTargetNs << " ns/check " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
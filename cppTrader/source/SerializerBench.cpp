@@ -0,0 +1,68 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "OrderType.h"
+#include "OrderSerializer.h"
+
+// ns/order of building the POST /v2/orders request: nlohmann toJSON()+dump() (+ beast header
+// fields, which is what alpaca_post_order(json) does) against OrderSerializer.
+
+template <class F>
+static double ns_per_op(std::uint64_t iterations, F&& op) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        op(i);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / double(iterations);
+}
+
+int run_serializer_benchmark(std::uint64_t iterations)
+{
+    const std::string host = "paper-api.alpaca.markets";
+    const std::string key_id = "PKXXXXXXXXXXXXXXXXXX";
+    const std::string secret = "SECRETXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX";
+
+    std::uint64_t sink = 0;
+    const SymbolId aapl = SymbolTable::getInstance().intern("AAPL");
+    const SymbolId msft = SymbolTable::getInstance().intern("MSFT");
+
+    // 1) Current path: DOM + dump
+    const double json_ns = ns_per_op(iterations, [&](std::uint64_t i) {
+        BuyOrder order((i & 1) ? msft : aapl, 1 + int(i % 10));
+        const std::string body = order.toJSON().dump();
+        sink += body.size();
+        });
+
+    // 2) Current path including the beast request alpaca_post_order builds around it
+    const double beast_ns = ns_per_op(iterations, [&](std::uint64_t i) {
+        BuyOrder order((i & 1) ? msft : aapl, 1 + int(i % 10));
+        http::request<http::string_body> req{ http::verb::post, "/v2/orders", 11 };
+        req.set(http::field::host, host);
+        req.set(http::field::user_agent, "alpaca-rest-async/1.0");
+        req.set(http::field::accept, "application/json");
+        req.set(http::field::content_type, "application/json");
+        req.set("APCA-API-KEY-ID", key_id);
+        req.set("APCA-API-SECRET-KEY", secret);
+        req.body() = order.toJSON().dump();
+        req.prepare_payload();
+        sink += req.body().size();
+        });
+
+    // 3) OrderSerializer: request line + headers + body from the queue message
+    OrderSerializer serializer(host, key_id, secret);
+    const double direct_ns = ns_per_op(iterations, [&](std::uint64_t i) {
+        const OrderMsg m = make_msg(i, (i & 1) == 0);
+        sink += serializer.serialize(m).size();
+        });
+
+    std::cout << "Orders              : " << iterations << "\n";
+    std::cout << "toJSON+dump         : " << json_ns << " ns/order\n";
+    std::cout << "toJSON+beast request: " << beast_ns << " ns/order\n";
+    std::cout << "OrderSerializer     : " << direct_ns << " ns/order (incl. make_msg)\n";
+    std::cout << "Speedup vs toJSON   : " << json_ns / direct_ns << "x\n";
+    std::cout << "Sample body         : " << serializer.body() << "\n";
+    std::cout << "Sink                : " << sink << "\n";
+
+    return 0;
+}
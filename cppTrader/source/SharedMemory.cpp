@@ -0,0 +1,340 @@
+#include "SharedMemory.h"
+
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+[[noreturn]] void throw_last_error(const std::string& iWhat)
+{
+#ifdef _WIN32
+    throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), iWhat);
+#else
+    throw std::system_error(errno, std::generic_category(), iWhat);
+#endif
+}
+
+#ifndef _WIN32
+// shm_open names must start with a single '/'.
+std::string posix_name(const std::string& iName)
+{
+    return (!iName.empty() && iName.front() == '/') ? iName : "/" + iName;
+}
+#endif
+
+}
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    release();
+}
+
+SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion&& o) noexcept
+    : mData(std::exchange(o.mData, nullptr)), mSize(std::exchange(o.mSize, 0)), mName(std::move(o.mName)),
+      mOwner(std::exchange(o.mOwner, false)), mFd(std::exchange(o.mFd, -1)), mHandle(std::exchange(o.mHandle, nullptr))
+{
+}
+
+SharedMemoryRegion& SharedMemoryRegion::operator=(SharedMemoryRegion&& o) noexcept
+{
+    if (this != &o) {
+        release();
+        mData = std::exchange(o.mData, nullptr);
+        mSize = std::exchange(o.mSize, 0);
+        mName = std::move(o.mName);
+        mOwner = std::exchange(o.mOwner, false);
+        mFd = std::exchange(o.mFd, -1);
+        mHandle = std::exchange(o.mHandle, nullptr);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept
+    : mData(std::exchange(o.mData, nullptr)), mSize(std::exchange(o.mSize, 0)), mPath(std::move(o.mPath)),
+      mFd(std::exchange(o.mFd, -1)), mFile(std::exchange(o.mFile, nullptr)), mHandle(std::exchange(o.mHandle, nullptr))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept
+{
+    if (this != &o) {
+        release();
+        mData = std::exchange(o.mData, nullptr);
+        mSize = std::exchange(o.mSize, 0);
+        mPath = std::move(o.mPath);
+        mFd = std::exchange(o.mFd, -1);
+        mFile = std::exchange(o.mFile, nullptr);
+        mHandle = std::exchange(o.mHandle, nullptr);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+SharedMemoryRegion SharedMemoryRegion::create(const std::string& iName, std::size_t iBytes)
+{
+    SharedMemoryRegion r;
+    const std::uint64_t bytes = iBytes;
+
+    r.mHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(bytes >> 32), static_cast<DWORD>(bytes & 0xFFFFFFFFu),
+        iName.empty() ? nullptr : iName.c_str());
+    if (!r.mHandle) throw_last_error("CreateFileMapping " + iName);
+
+    void* p = MapViewOfFile(r.mHandle, FILE_MAP_ALL_ACCESS, 0, 0, iBytes);
+    if (!p) throw_last_error("MapViewOfFile " + iName);
+
+    // Sections are zero-filled on creation, but not when the name already existed.
+    r.mData = static_cast<std::byte*>(p);
+    r.mSize = iBytes;
+    r.mName = iName;
+    r.mOwner = true;
+    std::memset(r.mData, 0, r.mSize);
+    return r;
+}
+
+SharedMemoryRegion SharedMemoryRegion::open(const std::string& iName)
+{
+    SharedMemoryRegion r;
+
+    r.mHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, iName.c_str());
+    if (!r.mHandle) throw_last_error("OpenFileMapping " + iName);
+
+    void* p = MapViewOfFile(r.mHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!p) throw_last_error("MapViewOfFile " + iName);
+
+    MEMORY_BASIC_INFORMATION info{};
+    VirtualQuery(p, &info, sizeof(info));
+
+    r.mData = static_cast<std::byte*>(p);
+    r.mSize = info.RegionSize;
+    r.mName = iName;
+    return r;
+}
+
+void SharedMemoryRegion::remove(const std::string&) noexcept
+{
+}
+
+void SharedMemoryRegion::release() noexcept
+{
+    if (mData) UnmapViewOfFile(mData);
+    if (mHandle) CloseHandle(mHandle);
+    mData = nullptr;
+    mHandle = nullptr;
+    mSize = 0;
+    mOwner = false;
+}
+
+MappedFile MappedFile::create(const std::string& iPath, std::size_t iBytes)
+{
+    MappedFile f;
+    f.mPath = iPath;
+
+    f.mFile = CreateFileA(iPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f.mFile == INVALID_HANDLE_VALUE) {
+        f.mFile = nullptr;
+        throw_last_error("CreateFile " + iPath);
+    }
+
+    // Sizing the section extends the file; the new range reads as zeros.
+    const std::uint64_t bytes = iBytes;
+    f.mHandle = CreateFileMappingA(f.mFile, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(bytes >> 32), static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (!f.mHandle) throw_last_error("CreateFileMapping " + iPath);
+
+    void* p = MapViewOfFile(f.mHandle, FILE_MAP_ALL_ACCESS, 0, 0, iBytes);
+    if (!p) throw_last_error("MapViewOfFile " + iPath);
+
+    f.mData = static_cast<std::byte*>(p);
+    f.mSize = iBytes;
+
+    WIN32_MEMORY_RANGE_ENTRY range{ p, iBytes };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    return f;
+}
+
+MappedFile MappedFile::open(const std::string& iPath)
+{
+    MappedFile f;
+    f.mPath = iPath;
+
+    f.mFile = CreateFileA(iPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f.mFile == INVALID_HANDLE_VALUE) {
+        f.mFile = nullptr;
+        throw_last_error("CreateFile " + iPath);
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(f.mFile, &size)) throw_last_error("GetFileSizeEx " + iPath);
+
+    f.mHandle = CreateFileMappingA(f.mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!f.mHandle) throw_last_error("CreateFileMapping " + iPath);
+
+    void* p = MapViewOfFile(f.mHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!p) throw_last_error("MapViewOfFile " + iPath);
+
+    f.mData = static_cast<std::byte*>(p);
+    f.mSize = static_cast<std::size_t>(size.QuadPart);
+    return f;
+}
+
+void MappedFile::flush_async() noexcept
+{
+    if (mData) FlushViewOfFile(mData, mSize);
+}
+
+void MappedFile::release() noexcept
+{
+    if (mData) UnmapViewOfFile(mData);
+    if (mHandle) CloseHandle(mHandle);
+    if (mFile) CloseHandle(mFile);
+    mData = nullptr;
+    mHandle = nullptr;
+    mFile = nullptr;
+    mSize = 0;
+}
+
+#else
+
+SharedMemoryRegion SharedMemoryRegion::create(const std::string& iName, std::size_t iBytes)
+{
+    SharedMemoryRegion r;
+
+#if defined(__linux__)
+    if (iName.empty()) {
+        r.mFd = ::memfd_create("cppTrader", MFD_CLOEXEC);
+        if (r.mFd < 0) throw_last_error("memfd_create");
+    }
+#endif
+    if (r.mFd < 0) {
+        r.mName = posix_name(iName);
+        r.mFd = ::shm_open(r.mName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (r.mFd < 0) throw_last_error("shm_open " + r.mName);
+        r.mOwner = true;
+    }
+
+    if (::ftruncate(r.mFd, static_cast<off_t>(iBytes)) != 0) throw_last_error("ftruncate " + r.mName);
+
+    void* p = ::mmap(nullptr, iBytes, PROT_READ | PROT_WRITE, MAP_SHARED, r.mFd, 0);
+    if (p == MAP_FAILED) throw_last_error("mmap " + r.mName);
+
+    r.mData = static_cast<std::byte*>(p);
+    r.mSize = iBytes;
+    return r;
+}
+
+SharedMemoryRegion SharedMemoryRegion::open(const std::string& iName)
+{
+    SharedMemoryRegion r;
+    r.mName = posix_name(iName);
+
+    r.mFd = ::shm_open(r.mName.c_str(), O_RDWR, 0600);
+    if (r.mFd < 0) throw_last_error("shm_open " + r.mName);
+
+    struct stat st {};
+    if (::fstat(r.mFd, &st) != 0) throw_last_error("fstat " + r.mName);
+
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, r.mFd, 0);
+    if (p == MAP_FAILED) throw_last_error("mmap " + r.mName);
+
+    r.mData = static_cast<std::byte*>(p);
+    r.mSize = static_cast<std::size_t>(st.st_size);
+    return r;
+}
+
+void SharedMemoryRegion::remove(const std::string& iName) noexcept
+{
+    ::shm_unlink(posix_name(iName).c_str());
+}
+
+void SharedMemoryRegion::release() noexcept
+{
+    if (mData) ::munmap(mData, mSize);
+    if (mFd >= 0) ::close(mFd);
+    if (mOwner && !mName.empty()) ::shm_unlink(mName.c_str());
+    mData = nullptr;
+    mSize = 0;
+    mFd = -1;
+    mOwner = false;
+}
+
+MappedFile MappedFile::create(const std::string& iPath, std::size_t iBytes)
+{
+    MappedFile f;
+    f.mPath = iPath;
+
+    f.mFd = ::open(iPath.c_str(), O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC, 0644);
+    if (f.mFd < 0) throw_last_error("open " + iPath);
+
+#if defined(__linux__)
+    // Reserve the blocks now: a full disk fails here instead of as SIGBUS on a later store.
+    if (const int err = ::posix_fallocate(f.mFd, 0, static_cast<off_t>(iBytes))) {
+        errno = err;
+        throw_last_error("posix_fallocate " + iPath);
+    }
+    const int flags = MAP_SHARED | MAP_POPULATE;
+#else
+    if (::ftruncate(f.mFd, static_cast<off_t>(iBytes)) != 0) throw_last_error("ftruncate " + iPath);
+    const int flags = MAP_SHARED;
+#endif
+
+    void* p = ::mmap(nullptr, iBytes, PROT_READ | PROT_WRITE, flags, f.mFd, 0);
+    if (p == MAP_FAILED) throw_last_error("mmap " + iPath);
+
+    f.mData = static_cast<std::byte*>(p);
+    f.mSize = iBytes;
+    return f;
+}
+
+MappedFile MappedFile::open(const std::string& iPath)
+{
+    MappedFile f;
+    f.mPath = iPath;
+
+    f.mFd = ::open(iPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (f.mFd < 0) throw_last_error("open " + iPath);
+
+    struct stat st {};
+    if (::fstat(f.mFd, &st) != 0) throw_last_error("fstat " + iPath);
+
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, f.mFd, 0);
+    if (p == MAP_FAILED) throw_last_error("mmap " + iPath);
+
+    f.mData = static_cast<std::byte*>(p);
+    f.mSize = static_cast<std::size_t>(st.st_size);
+    return f;
+}
+
+void MappedFile::flush_async() noexcept
+{
+    if (mData) ::msync(mData, mSize, MS_ASYNC);
+}
+
+void MappedFile::release() noexcept
+{
+    if (mData) ::munmap(mData, mSize);
+    if (mFd >= 0) ::close(mFd);
+    mData = nullptr;
+    mSize = 0;
+    mFd = -1;
+}
+
+#endif
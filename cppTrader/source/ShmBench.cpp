@@ -0,0 +1,172 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "OrderType.h"
+#include "FastQueue.hpp"
+
+// OrderMsg frames between two processes over a FastQueue placed in shared memory. Start the
+// producer first (it creates the queue), then the consumer with the same name:
+//   cppTrader shm-producer [name]
+//   cppTrader shm-consumer [name]
+// Run "cppTrader queue" for the in-process numbers on the same machine.
+// "cppTrader shm-restart [name]" checks that either side can die and attach again without
+// losing or reordering frames.
+
+using ShmQ = FastQueue<(1u << 20), 8, (1u << 12)>;
+
+static std::uint64_t order_checksum(const OrderMsg& m) {
+    return (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
+}
+
+static int run_shm_producer(const std::string& name, std::uint64_t messages)
+{
+    SharedMemoryRegion::remove(name);   // stale object from a crashed run
+    ShmQ q = ShmQ::create_shared(name);
+    auto prod = q.make_producer(OverflowPolicy::SpinWait);
+
+    std::cout << "Created " << name << " (" << ShmQ::kMappingBytes << " bytes), writing " << messages << " messages\n";
+
+    std::uint64_t checksum = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < messages; ++i) {
+        const OrderMsg m = make_msg(i, (i & 1) == 0);
+        checksum += order_checksum(m);
+        prod.write(std::as_bytes(std::span{ &m, 1 }));
+    }
+
+    // Keep the mapping (and the name) alive until the consumer has read everything.
+    while (prod.pending_bytes() != 0) {
+        boost::this_thread::yield();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Time       : " << seconds << " s\n";
+    std::cout << "Throughput : " << double(messages) / seconds << " msg/s\n";
+    std::cout << "Checksum   : " << checksum << "\n";
+    return 0;
+}
+
+static int run_shm_consumer(const std::string& name, std::uint64_t messages)
+{
+    ShmQ q = ShmQ::attach_shared(name);
+    auto cons = q.make_consumer();
+
+    std::uint64_t consumed = 0;
+    std::uint64_t checksum = 0;
+    std::chrono::steady_clock::time_point t0{};
+
+    while (consumed < messages) {
+        const std::size_t n = cons.read_batch([&](std::span<const std::byte> frame) {
+            OrderMsg m;
+            std::memcpy(&m, frame.data(), sizeof(m));
+            checksum += order_checksum(m);
+            });
+        if (n != 0 && consumed == 0) t0 = std::chrono::steady_clock::now();
+        consumed += n;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Consumed   : " << consumed << "\n";
+    std::cout << "Time       : " << seconds << " s\n";
+    std::cout << "Throughput : " << double(consumed) / seconds << " msg/s\n";
+    std::cout << "Checksum   : " << checksum << "\n";
+    return 0;
+}
+
+// Thrown from inside a write to stand for a producer killed between reserving and committing.
+struct ShmKilled {};
+
+// One owner creates the queue; a producer and a consumer thread each go through a series of
+// incarnations that map the queue by name, move a random number of frames and are dropped
+// without any goodbye (the producer sometimes mid-frame). Only the shared mapping carries state
+// from one incarnation to the next, as it would across real process restarts; what the sides
+// remember themselves is the next seq to send and to expect.
+static int run_shm_restart(const std::string& name, std::uint64_t messages)
+{
+    SharedMemoryRegion::remove(name);
+    ShmQ owner = ShmQ::create_shared(name);
+
+    std::atomic<bool> failed{ false };
+    std::uint64_t producer_lives = 0, consumer_lives = 0, torn = 0, overruns = 0;
+
+    boost::thread producer([&] {
+        std::uint64_t x = 0x9E3779B97F4A7C15ull;
+        std::uint64_t next = 0;
+        while (next < messages && !failed) {
+            ShmQ q = ShmQ::attach_shared(name);
+            auto prod = q.make_producer(OverflowPolicy::SpinWait);
+            ++producer_lives;
+
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            const std::uint64_t end = std::min(messages, next + 1 + x % 200'000);
+            try {
+                for (; next < end; ++next) {
+                    const OrderMsg m = make_msg(next, (next & 1) == 0);
+                    const bool die = (next + 1 == end) && next + 1 < messages && (x & 1);
+                    auto fill = [&](std::span<std::byte> dst) {
+                        if (die) throw ShmKilled{};
+                        std::memcpy(dst.data(), &m, sizeof(m));
+                    };
+                    while (!prod.try_write_with(sizeof(m), fill)) {
+                        if (failed) return;
+                        boost::this_thread::yield();
+                    }
+                }
+            }
+            catch (const ShmKilled&) {
+                ++torn;
+            }
+        }
+        });
+
+    std::uint64_t expect = 0;
+    std::uint64_t y = 0xD1B54A32D192ED03ull;
+    auto last = std::chrono::steady_clock::now();
+    while (expect < messages && !failed) {
+        ShmQ q = ShmQ::attach_shared(name);
+        auto cons = q.make_consumer();
+        ++consumer_lives;
+
+        y ^= y << 13; y ^= y >> 7; y ^= y << 17;
+        const std::uint64_t end = std::min(messages, expect + 1 + y % 200'000);
+        std::array<std::byte, 64> buf{};
+        while (expect < end) {
+            if (cons.try_read(buf) <= 0) {
+                if (std::chrono::steady_clock::now() - last > std::chrono::seconds(5)) {
+                    std::cout << "  no progress at seq " << expect << "\n";
+                    failed = true;
+                    break;
+                }
+                boost::this_thread::yield();
+                continue;
+            }
+            last = std::chrono::steady_clock::now();
+
+            OrderMsg m;
+            std::memcpy(&m, buf.data(), sizeof(m));
+            if (m.seq != expect) {
+                std::cout << "  expected seq " << expect << ", got " << m.seq << "\n";
+                failed = true;
+                break;
+            }
+            ++expect;
+        }
+        overruns += cons.overruns();
+    }
+    producer.join();
+
+    const bool pass = !failed && expect == messages && overruns == 0;
+    std::cout << "Restarts   : producer " << producer_lives << " (" << torn << " mid-frame), consumer " << consumer_lives << "\n";
+    std::cout << "Delivered  : " << expect << " of " << messages << " in order, " << overruns << " overruns\n";
+    std::cout << "Restart    : " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass ? 0 : 1;
+}
+
+int run_shm_benchmark(std::string_view role, const std::string& name, std::uint64_t messages)
+{
+    if (role == "producer") return run_shm_producer(name, messages);
+    if (role == "consumer") return run_shm_consumer(name, messages);
+    if (role == "restart") return run_shm_restart(name, messages);
+    std::cerr << "shm role must be producer, consumer or restart\n";
+    return 2;
+}
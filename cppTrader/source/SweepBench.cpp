@@ -0,0 +1,332 @@
+#include "common.h"
+#include "myboost.h"
+#include "Benchmark.h"
+#include "FastQueue.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+// FastQueue parameter sweep: queue shape (CapacityBytes / BlockAlignment /
+// ReservePublishBlockBytes) x payload size distribution x producer rate x core placement.
+// Every point runs kRepeats times; throughput is the median run, latency percentiles come from
+// the merged histogram of all runs. Paced points measure from each message's scheduled send time,
+// so a stalled producer shows up as latency instead of being coordinated away. Results go to <prefix>.csv and <prefix>.json, and are
+// checked against a baseline CSV from an earlier sweep when one is given.
+
+namespace {
+
+constexpr int kRepeats = 3;
+constexpr std::size_t kMinPayload = 16;        // seq + timestamp
+constexpr std::size_t kSizeTable = 4096;
+
+// Regression thresholds against the baseline.
+constexpr double kMaxThroughputDrop = 0.10;
+constexpr double kMaxP99Increase = 0.25;
+constexpr std::uint64_t kP99NoiseFloorNs = 1'000;
+
+struct PayloadDist {
+    std::string name;
+    std::size_t min_bytes;
+    std::size_t max_bytes;          // == min_bytes for fixed sizes
+};
+
+struct Placement {
+    unsigned producer_cpu;
+    unsigned consumer_cpu;
+};
+
+struct SweepPoint {
+    std::string queue;
+    std::size_t capacity = 0;
+    std::size_t alignment = 0;
+    std::size_t reserve_block = 0;
+    PayloadDist payload;
+    std::uint64_t rate = 0;         // messages/s, 0 = as fast as possible
+    Placement placement{};
+};
+
+struct SweepResult {
+    SweepPoint point;
+    std::uint64_t messages = 0;
+    double msg_per_sec = 0.0;       // median of the repeats
+    double msg_per_sec_min = 0.0;
+    double msg_per_sec_max = 0.0;
+    double mib_per_sec = 0.0;
+    HdrHistogram latency;
+};
+
+struct RunStats {
+    double seconds = 0.0;
+    std::uint64_t bytes = 0;
+};
+
+// Sizes are drawn from a fixed table so the producer loop does not pay for a RNG.
+std::vector<std::uint32_t> make_size_table(const PayloadDist& d)
+{
+    std::vector<std::uint32_t> sizes(kSizeTable);
+    std::uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (auto& s : sizes) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        s = static_cast<std::uint32_t>(d.min_bytes + (d.max_bytes > d.min_bytes ? x % (d.max_bytes - d.min_bytes + 1) : 0));
+    }
+    return sizes;
+}
+
+template <std::size_t Cap, std::size_t Align, std::size_t Reserve>
+RunStats run_once(const SweepPoint& p, std::uint64_t messages, const std::vector<std::uint32_t>& sizes, HdrHistogram& latency)
+{
+    auto q = std::make_unique<FastQueue<Cap, Align, Reserve>>();
+    auto prod = q->make_producer(OverflowPolicy::SpinWait);
+    auto cons = q->make_consumer();
+
+    const std::uint64_t freq = qpc_freq();
+    const std::uint64_t interval_ticks = p.rate ? freq / p.rate : 0;
+
+    boost::barrier start(2);
+    RunStats r;
+
+    boost::thread producer([&] {
+        pin_current_thread_to_cpu(p.placement.producer_cpu);
+        start.wait();
+
+        std::uint64_t next = qpc_now();
+        for (std::uint64_t i = 0; i < messages; ++i) {
+            std::uint64_t due = 0;
+            if (interval_ticks) {
+                due = next;
+                while (qpc_now() < due) cpu_relax();
+                next += interval_ticks;
+            }
+            const std::size_t size = sizes[i & (kSizeTable - 1)];
+            prod.write_with(size, [&](std::span<std::byte> dst) {
+                const std::uint64_t header[2] = { i, due ? due : qpc_now() };
+                std::memcpy(dst.data(), header, sizeof(header));
+                });
+        }
+        });
+
+    pin_current_thread_to_cpu(p.placement.consumer_cpu);
+
+    // Taken before the barrier so the clock is already running when the producer starts.
+    const auto t0 = std::chrono::steady_clock::now();
+    start.wait();
+
+    std::uint64_t consumed = 0;
+    while (consumed < messages) {
+        const std::size_t n = cons.read_batch([&](std::span<const std::byte> frame) {
+            std::uint64_t header[2];
+            std::memcpy(header, frame.data(), sizeof(header));
+            const std::uint64_t now = qpc_now();
+            const std::uint64_t ns = ticks_to_ns(now >= header[1] ? now - header[1] : 0, freq);
+            latency.add(ns);
+            r.bytes += frame.size();
+            });
+        if (n == 0) cpu_relax();
+        consumed += n;
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    producer.join();
+    return r;
+}
+
+template <std::size_t Cap, std::size_t Align, std::size_t Reserve>
+SweepResult run_point(SweepPoint p, std::uint64_t messages)
+{
+    p.capacity = Cap;
+    p.alignment = Align;
+    p.reserve_block = Reserve;
+
+    SweepResult res;
+    res.point = p;
+    res.messages = messages;
+
+    const auto sizes = make_size_table(p.payload);
+    std::vector<double> rates;
+    double mib = 0.0;
+
+    for (int i = 0; i < kRepeats; ++i) {
+        const RunStats s = run_once<Cap, Align, Reserve>(p, messages, sizes, res.latency);
+        rates.push_back(double(messages) / s.seconds);
+        mib += double(s.bytes) / s.seconds / (1024.0 * 1024.0);
+    }
+
+    std::sort(rates.begin(), rates.end());
+    res.msg_per_sec = rates[rates.size() / 2];
+    res.msg_per_sec_min = rates.front();
+    res.msg_per_sec_max = rates.back();
+    res.mib_per_sec = mib / kRepeats;
+    return res;
+}
+
+std::string point_key(const SweepPoint& p)
+{
+    std::ostringstream k;
+    k << p.capacity << ',' << p.alignment << ',' << p.reserve_block << ',' << p.payload.name << ','
+      << p.rate << ',' << p.placement.producer_cpu << ',' << p.placement.consumer_cpu;
+    return k.str();
+}
+
+constexpr const char* kCsvHeader =
+    "queue,capacity,alignment,reserve_block,payload,rate,producer_cpu,consumer_cpu,"
+    "repeats,messages,msg_per_sec,msg_per_sec_min,msg_per_sec_max,mib_per_sec,p50_ns,p99_ns,p999_ns,max_ns";
+
+void write_csv(const std::vector<SweepResult>& results, const std::string& path)
+{
+    std::ofstream f(path, std::ios::trunc);
+    f << kCsvHeader << "\n";
+    for (const auto& r : results) {
+        f << r.point.queue << ',' << point_key(r.point) << ',' << kRepeats << ',' << r.messages << ','
+          << r.msg_per_sec << ',' << r.msg_per_sec_min << ',' << r.msg_per_sec_max << ',' << r.mib_per_sec << ','
+          << r.latency.percentile(0.50) << ',' << r.latency.percentile(0.99) << ','
+          << r.latency.percentile(0.999) << ',' << r.latency.max_value() << "\n";
+    }
+}
+
+void write_json(const std::vector<SweepResult>& results, const std::string& path)
+{
+    nlohmann::json runs = nlohmann::json::array();
+    for (const auto& r : results) {
+        runs.push_back({
+            { "queue", r.point.queue },
+            { "capacity", r.point.capacity },
+            { "alignment", r.point.alignment },
+            { "reserve_block", r.point.reserve_block },
+            { "payload", r.point.payload.name },
+            { "rate", r.point.rate },
+            { "producer_cpu", r.point.placement.producer_cpu },
+            { "consumer_cpu", r.point.placement.consumer_cpu },
+            { "repeats", kRepeats },
+            { "messages", r.messages },
+            { "msg_per_sec", r.msg_per_sec },
+            { "msg_per_sec_min", r.msg_per_sec_min },
+            { "msg_per_sec_max", r.msg_per_sec_max },
+            { "mib_per_sec", r.mib_per_sec },
+            { "p50_ns", r.latency.percentile(0.50) },
+            { "p99_ns", r.latency.percentile(0.99) },
+            { "p999_ns", r.latency.percentile(0.999) },
+            { "max_ns", r.latency.max_value() },
+        });
+    }
+    std::ofstream f(path, std::ios::trunc);
+    f << nlohmann::json{ { "clock", TscClock::source_name() }, { "runs", runs } }.dump(2) << "\n";
+}
+
+struct BaselineRow {
+    double msg_per_sec = 0.0;
+    std::uint64_t p99_ns = 0;
+};
+
+// Keyed by the point columns; rows the baseline does not have are simply not compared.
+std::map<std::string, BaselineRow> read_baseline(const std::string& path)
+{
+    std::ifstream f(path);
+    if (!f) throw std::runtime_error("cannot open baseline " + path);
+
+    std::map<std::string, BaselineRow> rows;
+    std::string line;
+    std::getline(f, line);                  // header
+    while (std::getline(f, line)) {
+        std::vector<std::string> cols;
+        std::stringstream ss(line);
+        for (std::string c; std::getline(ss, c, ',');) cols.push_back(c);
+        if (cols.size() < 18) continue;
+
+        std::string key = cols[1];
+        for (int i = 2; i <= 7; ++i) key += ',' + cols[i];
+        rows[key] = BaselineRow{ std::stod(cols[10]), std::stoull(cols[15]) };
+    }
+    return rows;
+}
+
+int compare_baseline(const std::vector<SweepResult>& results, const std::string& path)
+{
+    const auto baseline = read_baseline(path);
+    int regressions = 0;
+    int compared = 0;
+
+    for (const auto& r : results) {
+        const auto it = baseline.find(point_key(r.point));
+        if (it == baseline.end()) continue;
+        ++compared;
+
+        const BaselineRow& b = it->second;
+        const std::uint64_t p99 = r.latency.percentile(0.99);
+
+        if (r.msg_per_sec < b.msg_per_sec * (1.0 - kMaxThroughputDrop)) {
+            ++regressions;
+            std::cout << "REGRESSION throughput " << r.point.queue << " [" << point_key(r.point) << "]: "
+                      << b.msg_per_sec << " -> " << r.msg_per_sec << " msg/s\n";
+        }
+        if (p99 > b.p99_ns + kP99NoiseFloorNs && double(p99) > double(b.p99_ns) * (1.0 + kMaxP99Increase)) {
+            ++regressions;
+            std::cout << "REGRESSION p99 " << r.point.queue << " [" << point_key(r.point) << "]: "
+                      << b.p99_ns << " -> " << p99 << " ns\n";
+        }
+    }
+
+    std::cout << "Baseline " << path << ": " << compared << " points compared, " << regressions << " regressions\n";
+    return regressions ? 3 : 0;
+}
+
+template <std::size_t Cap, std::size_t Align, std::size_t Reserve>
+void sweep_shape(const char* name, const std::vector<PayloadDist>& payloads, const std::vector<std::uint64_t>& rates,
+                 const std::vector<Placement>& placements, std::uint64_t messages, std::vector<SweepResult>& out)
+{
+    for (const auto& payload : payloads) {
+        for (const auto rate : rates) {
+            for (const auto& placement : placements) {
+                SweepPoint p;
+                p.queue = name;
+                p.payload = payload;
+                p.rate = rate;
+                p.placement = placement;
+
+                out.push_back(run_point<Cap, Align, Reserve>(p, messages));
+                const SweepResult& r = out.back();
+                std::cout << "  " << name << " " << payload.name << " rate=" << (rate ? std::to_string(rate) : "max")
+                          << " cpus=" << placement.producer_cpu << "/" << placement.consumer_cpu
+                          << "  " << r.msg_per_sec << " msg/s  p50=" << r.latency.percentile(0.50)
+                          << " p99=" << r.latency.percentile(0.99) << " ns\n";
+            }
+        }
+    }
+}
+
+}
+
+int run_sweep_benchmark(const std::string& out_prefix, const std::string& baseline, std::uint64_t messages)
+{
+    const std::vector<PayloadDist> payloads = {
+        { "fixed40", 40, 40 },
+        { "fixed256", 256, 256 },
+        { "uniform16-512", kMinPayload, 512 },
+    };
+    const std::vector<std::uint64_t> rates = { 0, 1'000'000 };
+
+    // Neighbouring cores, and the core half-way across (the other SMT thread or socket on most
+    // machines). Pinning to a core that does not exist is silently ignored.
+    const unsigned cores = std::max(2u, boost::thread::hardware_concurrency());
+    std::vector<Placement> placements = { { 0, 1 } };
+    if (cores / 2 > 1) placements.push_back({ 0, cores / 2 });
+
+    std::cout << "Sweep      : " << messages << " messages x " << kRepeats << " repeats per point, clock "
+              << TscClock::source_name() << "\n";
+
+    std::vector<SweepResult> results;
+    sweep_shape<(1u << 16), 8, (1u << 12)>("64K/8/4K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 16), 64, (1u << 12)>("64K/64/4K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 20), 8, (1u << 12)>("1M/8/4K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 20), 8, (1u << 16)>("1M/8/64K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 20), 64, (1u << 16)>("1M/64/64K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 24), 8, (1u << 12)>("16M/8/4K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 24), 8, (1u << 16)>("16M/8/64K", payloads, rates, placements, messages, results);
+    sweep_shape<(1u << 24), 64, (1u << 16)>("16M/64/64K", payloads, rates, placements, messages, results);
+
+    write_csv(results, out_prefix + ".csv");
+    write_json(results, out_prefix + ".json");
+    std::cout << "Results    : " << out_prefix << ".csv, " << out_prefix << ".json\n";
+
+    return baseline.empty() ? 0 : compare_baseline(results, baseline);
+}
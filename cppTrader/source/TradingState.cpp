@@ -0,0 +1,92 @@
+#include "TradingState.h"
+
+
+OrderMsg TradingState::make_order(SymbolId iSymbol, Action iSide, std::uint32_t iQty, std::uint64_t iNow) noexcept
+{
+    OrderMsg m{};
+    m.ts_qpc = iNow;
+    m.seq = mOrders.next_seq();
+    m.symbol = iSymbol;
+    m.qty = iQty;
+    m.action = iSide;
+    return m;
+}
+
+std::uint32_t TradingState::risk_check(const OrderMsg& iOrder, std::uint64_t iNow, double iLimitPrice) noexcept
+{
+    const double price = (iLimitPrice > 0.0) ? iLimitPrice : reference_price(iOrder.symbol);
+    return mRisk.check(iOrder, price, mAccount.buying_power(), iNow);
+}
+
+bool TradingState::apply_trade_update(const TradeUpdateMsg& iUpdate) noexcept
+{
+    mOrders.apply(iUpdate);
+
+    switch (iUpdate.event) {
+    case TradeEvent::New: {
+        // Market buys hold buying power at the price risk checked them at.
+        double price = iUpdate.limit_price;
+        if (price <= 0.0) price = reference_price(iUpdate.symbol);
+        mAccount.on_accepted(iUpdate.client_seq, iUpdate.side, iUpdate.order_qty, price);
+        return true;
+    }
+    case TradeEvent::Fill:
+    case TradeEvent::PartialFill:
+        if (mPositions.contains(iUpdate.symbol)) {
+            mPositions.apply_fill(iUpdate.symbol, iUpdate.side, iUpdate.fill_qty, iUpdate.fill_price);
+        }
+        mAccount.on_fill(iUpdate.client_seq, iUpdate.side, iUpdate.fill_qty, iUpdate.fill_price);
+        return true;
+    case TradeEvent::Canceled:
+    case TradeEvent::Expired:
+    case TradeEvent::Rejected:
+    case TradeEvent::Replaced:
+    case TradeEvent::DoneForDay:
+        mAccount.on_closed(iUpdate.client_seq);
+        return true;
+    default:
+        return false;
+    }
+}
+
+AccountDrift TradingState::reconcile_account(double iCash, double iBuyingPower) noexcept
+{
+    return mAccount.reconcile(iCash, iBuyingPower, [&](std::uint64_t iClientSeq) { return mOrders.is_open(iClientSeq); });
+}
+
+void TradingState::mark(SymbolId iSymbol, double iPrice) noexcept
+{
+    if (mPositions.contains(iSymbol)) mPositions.mark(iSymbol, iPrice);
+}
+
+double TradingState::reference_price(SymbolId iSymbol) const noexcept
+{
+    if (mQuotes && QuoteCache<>::contains(iSymbol)) {
+        Quote q;
+        mQuotes->read(iSymbol, q);
+        if (q.bid_price > 0.0 && q.ask_price > 0.0) return 0.5 * (q.bid_price + q.ask_price);
+        if (q.last_price > 0.0) return q.last_price;
+    }
+    Position p;
+    return position(iSymbol, p) ? p.mark : 0.0;
+}
+
+bool TradingState::position(SymbolId iSymbol, Position& oPosition) const noexcept
+{
+    if (!mPositions.contains(iSymbol)) return false;
+    mPositions.read(iSymbol, oPosition);
+    return true;
+}
+
+PositionTotals TradingState::totals() const noexcept
+{
+    return mPositions.totals(SymbolTable::getInstance().size());
+}
+
+AccountSnapshot TradingState::account() const noexcept
+{
+    AccountSnapshot a;
+    mAccount.read(a);
+    a.equity = a.cash + totals().net_exposure;
+    return a;
+}
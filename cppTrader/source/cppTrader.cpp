@@ -6,8 +6,13 @@
 #include "FastQueue.hpp"
 #include "Benchmark.h"
 #include "OrderType.h"
+#include "TradeUpdatePipeline.h"
+#include "MarketDataPipeline.h"
+#include "MockAlpacaServer.h"
+#include <fstream>
 
 // Helper: parse WebSocket payload (text or binary) into JSON.
+// Only used for control messages (auth/listen acks) and anything TradeUpdateDecoder rejects.
 static nlohmann::json parse_ws_payload(const beast::flat_buffer& buf, bool is_binary) {
     const auto* data = static_cast<const std::uint8_t*>(buf.data().data());
     const std::size_t n = buf.data().size();
@@ -18,10 +23,9 @@ static nlohmann::json parse_ws_payload(const beast::flat_buffer& buf, bool is_bi
         );
     }
 
-    // Binary frames: try MessagePack first; fall back to JSON bytes.
+    // Binary frames: try MessagePack first (straight from the frame bytes); fall back to JSON bytes.
     try {
-        std::vector<std::uint8_t> v(data, data + n);
-        return nlohmann::json::from_msgpack(v);
+        return nlohmann::json::from_msgpack(data, data + n);
     }
     catch (...) {
         return nlohmann::json::parse(
@@ -38,23 +42,17 @@ static awaitable<void> async_sleep(std::chrono::milliseconds d) {
     co_await t.async_wait(use_awaitable);
 }
 
-// Optional: route decoded events somewhere real.
+// Control messages (auth/listen acks). Trade updates never get here: they are
+// normalized and enqueued by TradeUpdatePublisher.
 static void handle_event(const nlohmann::json& msg) {
-    // In production youd normalize + enqueue into a bounded SPSC ring.
-    // For demo:
     std::cout << msg.dump() << "\n";
 }
 
-// One full connect->auth->listen->read session.
-// Returns only on error/disconnect (caller handles reconnect).
-static awaitable<void> run_one_session(
-    std::string host,
-    std::string port,
-    std::string path,
-    std::string key_id,
-    std::string secret,
-    ssl::context& tls_ctx
-) {
+using TlsWebSocket = ws::stream<beast::ssl_stream<beast::tcp_stream>>;
+
+// Resolve, TCP connect, TLS (with SNI) and WebSocket handshake; shared by every stream session.
+static awaitable<TlsWebSocket> connect_websocket(const std::string& host, const std::string& port, const std::string& path, ssl::context& tls_ctx)
+{
     auto ex = co_await asio::this_coro::executor;
 
     // 1) Resolve
@@ -111,10 +109,28 @@ static awaitable<void> run_one_session(
         throw beast::system_error(ec, "ws_handshake");
     }
 
+    co_return sock;
+}
+
+// One full connect->auth->listen->read session.
+// Returns only on error/disconnect (caller handles reconnect).
+template <class Publisher>
+static awaitable<void> run_one_session(
+    std::string host,
+    std::string port,
+    std::string path,
+    std::string key_id,
+    std::string secret,
+    ssl::context& tls_ctx,
+    Publisher& publisher
+) {
+    auto sock = co_await connect_websocket(host, port, path, tls_ctx);
+    beast::error_code ec;
+
     // We will be sending JSON text.
     sock.text(true);
 
-    // 5) Auth
+    // 2) Auth
     {
         nlohmann::json auth = {
             {"action", "auth"},
@@ -129,7 +145,7 @@ static awaitable<void> run_one_session(
         }
     }
 
-    // 6) Listen to trade_updates
+    // 3) Listen to trade_updates
     {
         nlohmann::json listen = {
             {"action", "listen"},
@@ -143,14 +159,22 @@ static awaitable<void> run_one_session(
         }
     }
 
-    // 7) Read loop
+    // 4) Read loop (one buffer for the whole session)
+    beast::flat_buffer buf;
     for (;;) {
-        beast::flat_buffer buf;
+        buf.consume(buf.size());
         co_await sock.async_read(buf, asio::redirect_error(use_awaitable, ec));
         if (ec) {
             // Normal disconnects often come here.
             throw beast::system_error(ec, "read");
         }
+        const std::uint64_t ts_recv = qpc_now();
+
+        // Alpaca sends trade_updates as JSON, in text or binary frames; decode in place.
+        const std::string_view frame(static_cast<const char*>(buf.data().data()), buf.data().size());
+        if (publisher.publish_frame(frame, ts_recv) > 0) {
+            continue;
+        }
 
         const bool is_binary = sock.got_binary();
         nlohmann::json msg;
@@ -170,15 +194,123 @@ static awaitable<void> run_one_session(
 }
 
 
+// Market-data session: connect, auth, subscribe, then feed every frame to the quote cache.
+// Alpaca's stocks stream answers auth and subscribe with control frames on the same socket.
+template <class Publisher>
+static awaitable<void> run_market_data_session(
+    std::string host,
+    std::string port,
+    std::string path,
+    std::string key_id,
+    std::string secret,
+    std::vector<std::string> symbols,
+    ssl::context& tls_ctx,
+    Publisher& publisher
+) {
+    auto sock = co_await connect_websocket(host, port, path, tls_ctx);
+    beast::error_code ec;
+    sock.text(true);
+
+    // 2) Auth
+    {
+        nlohmann::json auth = {
+            {"action", "auth"},
+            {"key", key_id},
+            {"secret", secret}
+        };
+        co_await sock.async_write(asio::buffer(auth.dump()), asio::redirect_error(use_awaitable, ec));
+        if (ec) {
+            throw beast::system_error(ec, "ws_write_auth");
+        }
+    }
+
+    // 3) Subscribe to trades, quotes and minute bars of every symbol
+    {
+        nlohmann::json subscribe = {
+            {"action", "subscribe"},
+            {"trades", symbols},
+            {"quotes", symbols},
+            {"bars", symbols}
+        };
+        co_await sock.async_write(asio::buffer(subscribe.dump()), asio::redirect_error(use_awaitable, ec));
+        if (ec) {
+            throw beast::system_error(ec, "ws_write_subscribe");
+        }
+    }
+
+    // 4) Read loop
+    beast::flat_buffer buf;
+    for (;;) {
+        buf.consume(buf.size());
+        co_await sock.async_read(buf, asio::redirect_error(use_awaitable, ec));
+        if (ec) {
+            throw beast::system_error(ec, "read");
+        }
+        const std::uint64_t ts_recv = qpc_now();
+
+        const std::string_view frame(static_cast<const char*>(buf.data().data()), buf.data().size());
+        if (publisher.publish_frame(frame, ts_recv) > 0) {
+            continue;
+        }
+
+        // Control frames: connected / authenticated / subscription / error.
+        try {
+            handle_event(parse_ws_payload(buf, sock.got_binary()));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "parse error: " << e.what() << "\n";
+        }
+    }
+}
+
+// Runs session() again forever with capped exponential backoff.
+template <class Session>
+static awaitable<void> reconnect_forever(const char* name, Session session)
+{
+    std::chrono::milliseconds backoff{ 250 };
+
+    while (true)
+    {
+        try
+        {
+            co_await session();
+            backoff = std::chrono::milliseconds{ 250 };
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[" << name << "] " << e.what() << ", reconnecting in " << backoff.count() << " ms\n";
+        }
+
+        co_await async_sleep(backoff);
+        backoff = std::min(backoff * 2, std::chrono::milliseconds{ 10'000 });
+    }
+}
+
+template <class Publisher>
+static awaitable<void> stream_trade_updates_forever(std::string host, std::string port, std::string path, ssl::context& tls_ctx, Publisher& publisher)
+{
+    co_await reconnect_forever("trade_updates", [&] {
+        return run_one_session(host, port, path, APCA_KEY_ID, APCA_SECRET, tls_ctx, publisher);
+        });
+}
+
+template <class Publisher>
+static awaitable<void> stream_market_data_forever(std::string host, std::string port, std::string path, std::vector<std::string> symbols, ssl::context& tls_ctx, Publisher& publisher)
+{
+    co_await reconnect_forever("market_data", [&] {
+        return run_market_data_session(host, port, path, APCA_KEY_ID, APCA_SECRET, symbols, tls_ctx, publisher);
+        });
+}
+
 template <class Consumer>
-awaitable<void> consumer_run_forever( Consumer consumer, BenchConfig benchmark, std::uint64_t qpcFrequency, boost::barrier& start_barrier, std::atomic<bool>& producer_done, BenchResults& out) 
+awaitable<void> consumer_run_forever( Consumer consumer, BenchConfig benchmark, std::uint64_t qpcFrequency, boost::barrier& start_barrier, std::atomic<bool>& producer_done, QueueDoorbell& doorbell, BenchResults& out) 
 {
     pin_current_thread_to_cpu(1);
 
     auto ex = co_await asio::this_coro::executor;
     asio::steady_timer t(ex);
 
-    std::array<std::byte, 256> buf{};
+    // The synchronous modes block this io thread on purpose: it runs nothing but this coroutine.
+    ConsumerWaiter waiter(benchmark.wait, benchmark.spin_limit, &doorbell);
 
     long double sum_ns_128 = 0;
 
@@ -188,43 +320,53 @@ awaitable<void> consumer_run_forever( Consumer consumer, BenchConfig benchmark,
 
     while (out.consumed < benchmark.messages) 
     {
-        int n = consumer.try_read(buf);
-        if (n <= 0) {
-            // async backoff (does not block io_context)
-            t.expires_after(benchmark.empty_backoff);
-            co_await t.async_wait(use_awaitable);
-            continue;
-        }
+        // Frames are read in place; the only copy is into the (packed) OrderMsg.
+        const std::size_t got = consumer.read_batch([&](std::span<const std::byte> frame)
+            {
+                if (frame.size() != sizeof(OrderMsg)) {
+                    // unexpected; skip
+                    return;
+                }
 
-        if ((std::size_t)n != sizeof(OrderMsg)) {
-            // unexpected; skip
-            continue;
-        }
+                OrderMsg m;
+                std::memcpy(&m, frame.data(), sizeof(m));
 
-        OrderMsg m{};
-        std::memcpy(&m, buf.data(), sizeof(m));
+                // "process": update checksum so compiler cant erase the loop
+                out.checksum += (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
 
-        // "process": update checksum so compiler cant erase the loop
-        out.checksum += (m.seq * 1315423911ull) ^ (m.qty * 2654435761ull);
+                // latency sampling
+                if (++sample_counter >= benchmark.sample_every) 
+                {
+                    sample_counter = 0;
 
-        // latency sampling
-        if (++sample_counter >= benchmark.sample_every) 
-        {
-            sample_counter = 0;
+                    std::uint64_t now = qpc_now();
+                    std::uint64_t dt_ticks = (now >= m.ts_qpc) ? (now - m.ts_qpc) : 0;
+                    std::uint64_t dt_ns = ticks_to_ns(dt_ticks, qpcFrequency);
 
-            std::uint64_t now = qpc_now();
-            std::uint64_t dt_ticks = (now >= m.ts_qpc) ? (now - m.ts_qpc) : 0;
-            std::uint64_t dt_ns = ticks_to_ns(dt_ticks, qpcFrequency);
+                    if (dt_ns < out.min_ns) out.min_ns = dt_ns;
+                    if (dt_ns > out.max_ns) out.max_ns = dt_ns;
 
-            if (dt_ns < out.min_ns) out.min_ns = dt_ns;
-            if (dt_ns > out.max_ns) out.max_ns = dt_ns;
+                    out.hist.add(dt_ns);
 
-            out.hist.add(dt_ns);
+                    sum_ns_128 += (long double)dt_ns;
+                }
 
-            sum_ns_128 += (long double)dt_ns;
+                ++out.consumed;
+            },
+            benchmark.messages - out.consumed);
+
+        if (got == 0) {
+            if (benchmark.wait == WaitMode::AsioTimer) {
+                // async backoff (does not block io_context)
+                t.expires_after(benchmark.empty_backoff);
+                co_await t.async_wait(use_awaitable);
+            }
+            else {
+                waiter.idle([&] { return !consumer.empty(); });
+            }
+            continue;
         }
-
-        ++out.consumed;
+        waiter.reset();
 
         (void)producer_done.load(std::memory_order_acquire);
     }
@@ -244,7 +386,7 @@ awaitable<void> consumer_run_forever( Consumer consumer, BenchConfig benchmark,
 }
 
 template <class Producer>
-void producer_thread_fn( Producer producer, BenchConfig cfg, boost::barrier& start_barrier, std::atomic<bool>& producer_done) {
+void producer_thread_fn( Producer producer, BenchConfig cfg, boost::barrier& start_barrier, std::atomic<bool>& producer_done, QueueDoorbell& doorbell) {
     pin_current_thread_to_cpu(0);
 
     start_barrier.wait();
@@ -256,12 +398,13 @@ void producer_thread_fn( Producer producer, BenchConfig cfg, boost::barrier& sta
         //to debug
         //print_msg(m);
         producer.write(std::as_bytes(std::span{ &m, 1 }));
+        doorbell.notify();
     }
 
     producer_done.store(true, std::memory_order_release);
 }
 
-int main() 
+static int run_queue_benchmark(WaitMode wait, const std::string& hist_out)
 {
     try
     {
@@ -273,6 +416,7 @@ int main()
         benchmark.messages = 5'000'000;
         benchmark.sample_every = 1;
         benchmark.empty_backoff = std::chrono::microseconds(10);
+        benchmark.wait = wait;
 
         using Q = FastQueue<(1u << 20), 8, (1u << 16)>;
 
@@ -283,6 +427,7 @@ int main()
         // Barrier to start both threads at the same time
         boost::barrier start_barrier(2);
         std::atomic<bool> producer_done{ false };
+        QueueDoorbell doorbell;
 
         // Start the asio event loop in this main thread
         asio::io_context ioc;
@@ -311,6 +456,7 @@ int main()
             freq_l,
             &start_barrier,
             &producer_done,
+            &doorbell,
             &results,
             timing,
             &ioc]() mutable -> awaitable<void>
@@ -323,6 +469,7 @@ int main()
                     freq_l,
                     start_barrier,
                     producer_done,
+                    doorbell,
                     results
                 );
 
@@ -334,7 +481,7 @@ int main()
         );
 
         // Producer thread
-        boost::thread producer_thr( &producer_thread_fn<decltype(prod)>, std::move(prod), benchmark, std::ref(start_barrier), std::ref(producer_done));
+        boost::thread producer_thr( &producer_thread_fn<decltype(prod)>, std::move(prod), benchmark, std::ref(start_barrier), std::ref(producer_done), std::ref(doorbell));
 
         producer_thr.join();
         io_thread.join();
@@ -345,6 +492,8 @@ int main()
         const double bytes_per_sec = (double(benchmark.messages) * double(sizeof(OrderMsg))) / seconds;
         const double mib_per_sec = bytes_per_sec / (1024.0 * 1024.0);
 
+        std::cout << "Wait mode  : " << to_string(benchmark.wait) << "\n";
+        std::cout << "Clock      : " << TscClock::source_name() << " @ " << qpc_freq() << " Hz\n";
         std::cout << "Messages   : " << benchmark.messages << "\n";
         std::cout << "Msg size   : " << sizeof(OrderMsg) << " bytes\n";
         std::cout << "Time       : " << seconds << " s\n";
@@ -357,13 +506,21 @@ int main()
         {
             std::cout << "\nLatency (ns) over " << results.hist.total << " samples:\n";
             std::cout << "  min   : " << results.min_ns << "\n";
-            std::cout << "  p50~  : " << results.hist.percentile(0.50) << " (bucket upper bound)\n";
-            std::cout << "  p99~  : " << results.hist.percentile(0.99) << " (bucket upper bound)\n";
-            std::cout << "  p99.9~: " << results.hist.percentile(0.999) << " (bucket upper bound)\n";
+            std::cout << "  p50   : " << results.hist.percentile(0.50) << "\n";
+            std::cout << "  p99   : " << results.hist.percentile(0.99) << "\n";
+            std::cout << "  p99.9 : " << results.hist.percentile(0.999) << "\n";
+            std::cout << "  p99.99: " << results.hist.percentile(0.9999) << "\n";
             std::cout << "  max   : " << results.max_ns << "\n";
             std::cout << "  avg   : " << results.avg_ns << "\n";
         }
 
+        if (!hist_out.empty()) {
+            if (!save_histogram(results.hist, hist_out)) {
+                std::cerr << "could not write " << hist_out << "\n";
+                return 1;
+            }
+            std::cout << "Histogram  : " << hist_out << "\n";
+        }
     }
     catch (const std::exception& e) {
         std::cerr << "fatal: " << e.what() << "\n";
@@ -372,3 +529,536 @@ int main()
 
     return 0;
 }
+
+// Live stocks stream (IEX feed) into the Portfolio's QuoteCache, which risk prices market orders
+// from; a reader thread prints the snapshots that changed every second, publisher stats are
+// printed every 10 s.
+static int run_market_data_live(std::vector<std::string> symbols)
+{
+    using LiveQuoteCache = QuoteCache<>;
+
+    const std::uint64_t freq = qpc_freq();
+    const std::string host = "stream.data.alpaca.markets";
+
+    ssl::context tls_ctx(ssl::context::tls_client);
+    tls_ctx.set_default_verify_paths();
+    tls_ctx.set_verify_mode(ssl::verify_peer);
+    tls_ctx.load_verify_file(CACERT_LOCATION);
+    tls_ctx.set_verify_callback(ssl::host_name_verification(host));
+
+    SymbolTable& registry = SymbolTable::getInstance();
+    std::vector<SymbolId> ids;
+    for (const auto& s : symbols) ids.push_back(registry.intern(s));
+
+    LiveQuoteCache& cache = Portfolio::getInstance().quotes();
+    MarketDataPublisher<LiveQuoteCache> publisher(cache, freq);
+
+    boost::thread reader_thr([&]
+        {
+            pin_current_thread_to_cpu(1);
+            std::vector<std::uint32_t> seen(ids.size(), 0);
+            Quote q;
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                for (std::size_t i = 0; i < ids.size(); ++i) {
+                    if (!cache.contains(ids[i]) || cache.version(ids[i]) == seen[i]) continue;
+                    cache.read(ids[i], q);
+                    seen[i] = q.version;
+                    std::cout << registry.name(ids[i]) << " bid=" << q.bid_price << "x" << q.bid_size
+                        << " ask=" << q.ask_price << "x" << q.ask_size
+                        << " last=" << q.last_price << " bar_close=" << q.bar_close << "\n";
+                }
+            }
+        });
+
+    asio::io_context ioc;
+
+    asio::co_spawn(ioc, stream_market_data_forever(host, "443", "/v2/iex", symbols, tls_ctx, publisher), asio::detached);
+
+    asio::co_spawn(ioc,
+        [&]() -> awaitable<void> {
+            for (;;) {
+                co_await async_sleep(std::chrono::seconds(10));
+                const auto& st = publisher.stats();
+                std::cout << "[market_data] frames=" << st.frames << " trades=" << st.trades << " quotes=" << st.quotes
+                    << " bars=" << st.bars << " unknown=" << st.unknown_symbols << " other=" << st.other << "\n";
+                print_stage("publish    ", st.publish);
+            }
+        },
+        asio::detached);
+
+    ioc.run();
+    reader_thr.join();
+    return 0;
+}
+
+// Live trade_updates stream: the io thread publishes normalized fills, a pinned consumer
+// thread drains them; per-stage latencies are printed every 10 s.
+static int run_trade_updates_live()
+{
+    const std::uint64_t freq = qpc_freq();
+    const std::string host = "paper-api.alpaca.markets";
+
+    ssl::context tls_ctx(ssl::context::tls_client);
+    tls_ctx.set_default_verify_paths();
+    tls_ctx.set_verify_mode(ssl::verify_peer);
+    tls_ctx.load_verify_file(CACERT_LOCATION);
+    tls_ctx.set_verify_callback(ssl::host_name_verification(host));
+
+    TradeUpdateQueue q;
+    TradeUpdatePublisher publisher(q.make_producer(), freq);
+    TradeUpdateSubscriber subscriber(q.make_consumer(), freq);
+
+    boost::thread consumer_thr([&]
+        {
+            pin_current_thread_to_cpu(1);
+            std::uint64_t last_report = 0;
+            for (;;) {
+                const std::size_t got = subscriber.drain([](const TradeUpdateMsg& m) {
+                    std::cout << "trade_update event=" << int(m.event) << " " << SymbolTable::getInstance().name(m.symbol)
+                        << " qty=" << m.fill_qty << " price=" << m.fill_price
+                        << " cum=" << m.cum_qty << " order=" << m.order_id << "\n";
+                    });
+                if (got == 0) {
+                    boost::this_thread::yield();
+                    continue;
+                }
+
+                const auto& st = subscriber.stats();
+                if (st.consumed - last_report >= 100) {
+                    last_report = st.consumed;
+                    std::cout << "[consumer] " << st.consumed << " updates\n";
+                    print_stage("queue      ", st.queue);
+                    print_stage("end_to_end ", st.end_to_end);
+                }
+            }
+        });
+
+    asio::io_context ioc;
+
+    asio::co_spawn(ioc, stream_trade_updates_forever(host, "443", "/stream", tls_ctx, publisher), asio::detached);
+
+    asio::co_spawn(ioc,
+        [&]() -> awaitable<void> {
+            for (;;) {
+                co_await async_sleep(std::chrono::seconds(10));
+                const auto& st = publisher.stats();
+                std::cout << "[reader] frames=" << st.frames << " updates=" << st.updates
+                    << " other=" << st.other_frames << "\n";
+                print_stage("decode     ", st.decode);
+                print_stage("enqueue    ", st.enqueue);
+            }
+        },
+        asio::detached);
+
+    ioc.run();
+    consumer_thr.join();
+    return 0;
+}
+
+// Client TLS context that trusts only the mock's self-signed certificate.
+static ssl::context mock_client_tls(const MockAlpacaServer& server, const std::string& host)
+{
+    ssl::context tls_ctx(ssl::context::tls_client);
+    tls_ctx.set_verify_mode(ssl::verify_peer);
+    tls_ctx.add_certificate_authority(asio::buffer(server.certificate_pem()));
+    tls_ctx.set_verify_callback(ssl::host_name_verification(host));
+    return tls_ctx;
+}
+
+// MockAlpacaServer has no stocks stream: push one IEX quote per traded symbol through the same
+// MarketDataPublisher a live feed uses, so risk can price the market orders.
+static void publish_mock_quotes(Portfolio& iPortfolio, double iPrice, std::uint64_t iFreq)
+{
+    MarketDataPublisher<QuoteCache<>> publisher(iPortfolio.quotes(), iFreq);
+    const std::string px = std::to_string(iPrice);
+    std::string frame = "[";
+    for (const char* symbol : { "AAPL", "MSFT" }) {
+        SymbolTable::getInstance().intern(symbol);
+        if (frame.size() > 1) frame += ',';
+        frame += R"({"T":"q","S":")" + std::string(symbol) + R"(","bp":)" + px + R"(,"bs":1,"ap":)" + px + R"(,"as":1})";
+    }
+    frame += ']';
+    publisher.publish_frame(frame, qpc_now());
+}
+
+// Full order round trip against MockAlpacaServer on this machine: Portfolio posts market orders
+// over the keep-alive pool with `in_flight` outstanding, the mock acks them and pushes new + fill
+// on trade_updates, and run_one_session feeds the fills through the usual TradeUpdateQueue.
+// Reports ack latency (post -> 200), fill latency (post -> fill dequeued) and orders/s.
+static int run_e2e_benchmark(std::uint64_t orders, std::size_t in_flight, MockAlpacaServer::Config mock_cfg)
+{
+    const std::uint64_t freq = qpc_freq();
+    const std::string host = "localhost";
+
+    asio::io_context server_ioc;
+    MockAlpacaServer server(server_ioc.get_executor(), mock_cfg);
+    server.start();
+    boost::thread server_thr([&] { server_ioc.run(); });
+
+    const std::string port = std::to_string(server.port());
+    ssl::context tls_ctx = mock_client_tls(server, host);
+
+    // Static and created before the Portfolio singleton, so the pooled sockets are destroyed
+    // while their io_context still exists.
+    static asio::io_context ioc;
+    Portfolio& portfolio = Portfolio::getInstance("e2e", 100000.0, host, port);
+    portfolio.trust_certificate(server.certificate_pem());
+    // The mock has no request budget; the scheduler still sits on the path, it just never throttles.
+    portfolio.set_rest_rate_limit({ 60e9, 1e6 });
+    publish_mock_quotes(portfolio, mock_cfg.fill_price, freq);
+
+    TradeUpdateQueue q;
+    TradeUpdatePublisher publisher(q.make_producer(), freq, portfolio.orders().id_prefix());
+    TradeUpdateSubscriber subscriber(q.make_consumer(), freq);
+
+    // Indexed by OrderMsg::seq (1..orders). Written on the io thread before the post; the fill
+    // comes back through the queue, which orders it before the consumer's read.
+    std::vector<std::uint64_t> sent_at(orders + 1, 0);
+    HdrHistogram ack_ns;
+    HdrHistogram fill_ns;
+    std::atomic<std::uint64_t> fills{ 0 };
+    std::atomic<bool> stop{ false };
+    std::uint64_t errors = 0;
+
+    boost::thread consumer_thr([&]
+        {
+            pin_current_thread_to_cpu(1);
+            while (!stop.load(std::memory_order_acquire)) {
+                const std::size_t got = subscriber.drain([&](const TradeUpdateMsg& m) {
+                    portfolio.apply_trade_update(m);
+                    if (m.event != TradeEvent::Fill || m.client_seq == 0 || m.client_seq > orders) return;
+                    const std::uint64_t now = qpc_now();
+                    fill_ns.add(ticks_to_ns(now - sent_at[m.client_seq], freq));
+                    fills.fetch_add(1, std::memory_order_release);
+                    });
+                if (got == 0) boost::this_thread::yield();
+            }
+        });
+
+    double seconds = 0.0;
+    AccountSnapshot account_before;
+    AccountDrift drift;
+
+    asio::co_spawn(ioc, stream_trade_updates_forever(host, port, "/stream", tls_ctx, publisher), asio::detached);
+
+    asio::co_spawn(ioc,
+        [&]() -> awaitable<void> {
+            co_await portfolio.start_rest_pool(in_flight);
+            co_await portfolio.reconcile_account();
+
+            // Orders sent before the listen ack would be filled unseen.
+            while (publisher.stats().other_frames < 2) co_await async_sleep(std::chrono::milliseconds(1));
+
+            auto ex = co_await asio::this_coro::executor;
+            std::uint64_t next = 1;
+            std::size_t running = in_flight;
+            asio::steady_timer all_acked(ex, std::chrono::steady_clock::time_point::max());
+
+            const auto t0 = std::chrono::steady_clock::now();
+
+            for (std::size_t w = 0; w < in_flight; ++w) {
+                asio::co_spawn(ex,
+                    [&]() -> awaitable<void> {
+                        while (next <= orders) {
+                            const std::uint64_t seq = next++;
+                            const OrderMsg m = make_msg(seq, (seq & 1) == 0);
+                            sent_at[m.seq] = m.ts_qpc;
+                            try {
+                                co_await portfolio.alpaca_post_order(m);
+                                ack_ns.add(ticks_to_ns(qpc_now() - m.ts_qpc, freq));
+                            }
+                            catch (const std::exception& e) {
+                                if (errors++ == 0) std::cerr << "[e2e] " << e.what() << "\n";
+                            }
+                        }
+                        if (--running == 0) all_acked.cancel();
+                    },
+                    asio::detached);
+            }
+
+            beast::error_code ec;
+            co_await all_acked.async_wait(asio::redirect_error(use_awaitable, ec));
+
+            // Rejected orders never fill; give the rest a bounded grace period.
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (fills.load(std::memory_order_acquire) + errors < orders && std::chrono::steady_clock::now() < deadline) {
+                co_await async_sleep(std::chrono::milliseconds(1));
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            account_before = portfolio.account();
+            drift = co_await portfolio.reconcile_account();
+
+            stop.store(true, std::memory_order_release);
+            ioc.stop();
+        },
+        asio::detached);
+
+    ioc.run();
+    consumer_thr.join();
+
+    server_ioc.stop();
+    server_thr.join();
+
+    const std::uint64_t filled = fills.load();
+    std::cout << "Mock       : 127.0.0.1:" << port << " latency " << mock_cfg.latency.count() << " us + jitter "
+        << mock_cfg.jitter.count() << " us, fill after " << mock_cfg.fill_delay.count() << " us\n";
+    std::cout << "Clock      : " << TscClock::source_name() << " @ " << freq << " Hz\n";
+    std::cout << "Orders     : " << orders << " (" << in_flight << " in flight), " << errors << " errors, "
+        << filled << " fills seen, " << server.stats().connections << " server connections\n";
+    std::cout << "Time       : " << seconds << " s\n";
+    std::cout << "Throughput : " << double(orders - errors) / seconds << " orders/s\n";
+    std::cout << "\nLatency (ns):\n";
+    print_stage("ack        ", ack_ns);
+    print_stage("fill       ", fill_ns);
+    print_stage("ws decode  ", publisher.stats().decode);
+    print_stage("ws enqueue ", publisher.stats().enqueue);
+    print_stage("queue      ", subscriber.stats().queue);
+
+    std::cout << "\nPositions:\n";
+    const SymbolTable& symbols = SymbolTable::getInstance();
+    for (SymbolId id = 0; id < symbols.size(); ++id) {
+        Position p;
+        if (!portfolio.position(id, p) || p.fills == 0) continue;
+        std::cout << "  " << symbols.name(id) << " qty=" << p.qty << " avg=" << p.avg_cost << " realized=" << p.realized
+            << " unrealized=" << p.unrealized << " exposure=" << p.exposure << " fills=" << p.fills << "\n";
+    }
+    const PositionTotals totals = portfolio.totals();
+    std::cout << "  total realized=" << totals.realized << " unrealized=" << totals.unrealized
+        << " gross=" << totals.gross_exposure << "\n";
+    std::cout << "\nAccount (local, from " << account_before.updates << " trade updates):\n";
+    std::cout << "  cash=" << account_before.cash << " buying_power=" << account_before.buying_power
+        << " reserved=" << account_before.reserved << " equity=" << account_before.equity << "\n";
+    std::cout << "  drift vs /v2/account: cash=" << drift.cash << " buying_power=" << drift.buying_power << "\n";
+
+    const auto oms = portfolio.orders().stats();
+    std::cout << "\nOMS        : " << oms.opened << " opened, " << oms.closed << " closed, " << oms.open << " open, "
+        << oms.untracked << " untracked, " << oms.illegal << " illegal updates\n";
+
+    if (const RestScheduler* sched = portfolio.rest_scheduler()) {
+        std::cout << "\nREST scheduler (queueing delay, ns):\n";
+        for (RestPriority p : { RestPriority::Order, RestPriority::Account }) {
+            const RestScheduler::ClassStats& st = sched->stats(p);
+            std::cout << "  " << rest_priority_name(p) << ": " << st.granted << " granted, " << st.immediate << " immediate, "
+                << st.coalesced << " coalesced, max queued " << st.max_queued << "\n";
+            print_stage("delay      ", st.delay);
+        }
+    }
+
+    return (errors == 0 && filled == orders) ? 0 : 1;
+}
+
+// Tick-to-trade against MockAlpacaServer: every fill read from trade_updates is a tick the
+// strategy thread answers with one new order, so each traced order crosses the whole pipeline:
+// ws frame -> decode -> TradeUpdateQueue -> strategy -> order queue -> serialize -> socket -> ack.
+// `in_flight` untraced seed orders start the loop; the report is LatencyTracer's breakdown.
+static int run_tick_to_trade_benchmark(std::uint64_t orders, std::size_t in_flight, MockAlpacaServer::Config mock_cfg)
+{
+    const std::uint64_t freq = qpc_freq();
+    const std::string host = "localhost";
+
+    asio::io_context server_ioc;
+    MockAlpacaServer server(server_ioc.get_executor(), mock_cfg);
+    server.start();
+    boost::thread server_thr([&] { server_ioc.run(); });
+
+    const std::string port = std::to_string(server.port());
+    ssl::context tls_ctx = mock_client_tls(server, host);
+
+    static asio::io_context ioc;    // see run_e2e_benchmark
+    Portfolio& portfolio = Portfolio::getInstance("t2t", 100000.0, host, port);
+    portfolio.trust_certificate(server.certificate_pem());
+    portfolio.set_rest_rate_limit({ 60e9, 1e6 });    // see run_e2e_benchmark
+    publish_mock_quotes(portfolio, mock_cfg.fill_price, freq);
+
+    TradeUpdateQueue q;
+    TradeUpdatePublisher publisher(q.make_producer(), freq, portfolio.orders().id_prefix());
+    TradeUpdateSubscriber subscriber(q.make_consumer(), freq);
+
+    // Strategy thread -> io thread.
+    using OrderQueue = FastQueue<(1u << 16), 8, (1u << 12)>;
+    OrderQueue oq;
+    auto order_prod = oq.make_producer();
+    auto order_cons = oq.make_consumer();
+
+    LatencyTracer tracer;
+    std::atomic<bool> stop{ false };
+
+    boost::thread strategy_thr([&]
+        {
+            pin_current_thread_to_cpu(1);
+            std::uint64_t seq = in_flight;                      // seeds are 1..in_flight
+            const std::uint64_t last_seq = in_flight + orders;
+
+            while (!stop.load(std::memory_order_acquire)) {
+                const std::size_t got = subscriber.drain([&](const TradeUpdateMsg& m) {
+                    if (m.event == TradeEvent::Fill && m.client_seq != 0 && seq < last_seq) {
+                        const std::uint64_t ts_dequeued = qpc_now();
+
+                        ++seq;
+                        const OrderMsg o = make_msg(seq, (seq & 1) == 0);
+                        tracer.begin(o.seq, m.ts_recv, m.ts_decoded, m.ts_enqueued, ts_dequeued);
+                        order_prod.write(std::as_bytes(std::span{ &o, 1 }));
+                    }
+                    // Book keeping (OMS, positions, account) after the next order is on its way.
+                    portfolio.apply_trade_update(m);
+                    });
+                if (got == 0) boost::this_thread::yield();
+            }
+        });
+
+    double seconds = 0.0;
+    std::uint64_t errors = 0;
+
+    asio::co_spawn(ioc, stream_trade_updates_forever(host, port, "/stream", tls_ctx, publisher), asio::detached);
+
+    asio::co_spawn(ioc,
+        [&]() -> awaitable<void> {
+            co_await portfolio.start_rest_pool(in_flight);
+            while (publisher.stats().other_frames < 2) co_await async_sleep(std::chrono::milliseconds(1));
+
+            auto ex = co_await asio::this_coro::executor;
+            auto send = [&](OrderMsg m) -> awaitable<void> {
+                try {
+                    co_await portfolio.alpaca_post_order(m, &tracer);
+                }
+                catch (const std::exception& e) {
+                    if (errors++ == 0) std::cerr << "[t2t] " << e.what() << "\n";
+                }
+            };
+
+            const auto t0 = std::chrono::steady_clock::now();
+            const auto deadline = t0 + std::chrono::seconds(60);
+
+            for (std::uint64_t s = 1; s <= in_flight; ++s) {
+                asio::co_spawn(ex, send(make_msg(s, (s & 1) == 0)), asio::detached);
+            }
+
+            // Poll the order queue without starving the WebSocket reader on the same thread:
+            // yield to other handlers first, fall back to a short timer when idle.
+            asio::steady_timer idle(ex);
+            unsigned empty_polls = 0;
+            while (tracer.completed() + errors < orders && std::chrono::steady_clock::now() < deadline) {
+                const std::size_t got = order_cons.read_batch([&](std::span<const std::byte> frame) {
+                    OrderMsg m;
+                    std::memcpy(&m, frame.data(), sizeof(m));
+                    asio::co_spawn(ex, send(m), asio::detached);
+                    });
+
+                if (got > 0 || ++empty_polls < 64) {
+                    if (got > 0) empty_polls = 0;
+                    co_await asio::post(ex, use_awaitable);
+                    continue;
+                }
+                idle.expires_after(std::chrono::microseconds(10));
+                co_await idle.async_wait(use_awaitable);
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            stop.store(true, std::memory_order_release);
+            ioc.stop();
+        },
+        asio::detached);
+
+    ioc.run();
+    strategy_thr.join();
+
+    server_ioc.stop();
+    server_thr.join();
+
+    std::cout << "Mock       : 127.0.0.1:" << port << " latency " << mock_cfg.latency.count() << " us + jitter "
+        << mock_cfg.jitter.count() << " us, fill after " << mock_cfg.fill_delay.count() << " us\n";
+    std::cout << "Clock      : " << TscClock::source_name() << " @ " << freq << " Hz\n";
+    std::cout << "Orders     : " << tracer.completed() << " traced of " << orders << " (" << in_flight << " in flight), "
+        << errors << " errors\n";
+    std::cout << "Time       : " << seconds << " s\n";
+    std::cout << "Throughput : " << double(tracer.completed()) / seconds << " orders/s\n";
+    std::cout << "\nTick-to-trade breakdown (ns):\n";
+    tracer.print_report(std::cout);
+
+    return (errors == 0 && tracer.completed() == orders) ? 0 : 1;
+}
+
+// Standalone mock for other processes; the certificate is written next to the binary so clients
+// can trust it.
+static int run_mock_server(unsigned short port, MockAlpacaServer::Config cfg)
+{
+    asio::io_context ioc;
+    cfg.port = port;
+    MockAlpacaServer server(ioc.get_executor(), cfg);
+    server.start();
+
+    const char* cert_path = "mock-alpaca-cert.pem";
+    std::ofstream(cert_path, std::ios::trunc) << server.certificate_pem();
+
+    std::cout << "Mock Alpaca on https://localhost:" << server.port() << " (wss://localhost:" << server.port()
+        << "/stream), certificate " << cert_path << "\n";
+    ioc.run();
+    return 0;
+}
+
+// Usage: cppTrader [queue [spin|yield|block|timer] [latency.hdr]|hdr-report <files>|sweep [out_prefix] [baseline.csv]|serializer|decoder|mpsc|broadcast|shm-producer|shm-consumer|shm-restart [name]|journal [dir]|journal-replay <dir> <name> [paced]|trade-updates|market-data [symbols...]|quotes|risk|oms|rest-sched|backtest [threads]|e2e|t2t [orders] [latency_us] [jitter_us]|mock-server [port] [latency_us] [jitter_us]]   (default: queue)
+int main(int argc, char** argv)
+{
+    const std::string_view mode = (argc > 1) ? argv[1] : "queue";
+    TscClock::calibration();    // calibrate before any thread takes timestamps
+
+    try
+    {
+        if (mode == "queue") {
+            WaitMode wait = WaitMode::AsioTimer;
+            if (argc > 2 && !parse_wait_mode(argv[2], wait)) {
+                std::cerr << "wait mode must be spin, yield, block or timer\n";
+                return 2;
+            }
+            return run_queue_benchmark(wait, (argc > 3) ? argv[3] : "");
+        }
+        if (mode == "serializer") return run_serializer_benchmark(5'000'000);
+        if (mode == "decoder") return run_decoder_benchmark(1'000'000);
+        if (mode == "mpsc") return run_mpsc_benchmark(1'000'000, 4);
+        if (mode == "broadcast") return run_broadcast_benchmark(2'000'000, 4);
+        if (mode == "shm-producer" || mode == "shm-consumer" || mode == "shm-restart") {
+            const std::string name = (argc > 2) ? argv[2] : "cppTrader-orders";
+            return run_shm_benchmark(mode.substr(4), name, 5'000'000);
+        }
+        if (mode == "journal") return run_journal_benchmark((argc > 2) ? argv[2] : "journal", 2'000'000);
+        if (mode == "journal-replay" && argc > 3) {
+            return run_journal_replay(argv[2], argv[3], argc > 4 && std::string_view(argv[4]) == "paced");
+        }
+        if (mode == "sweep") {
+            // Non-zero exit (3) when the baseline comparison finds a regression.
+            return run_sweep_benchmark((argc > 2) ? argv[2] : "sweep_results", (argc > 3) ? argv[3] : "", 200'000);
+        }
+        if (mode == "hdr-report") return run_hdr_report(std::vector<std::string>(argv + 2, argv + argc));
+        if (mode == "trade-updates") return run_trade_updates_live();
+        if (mode == "market-data") {
+            std::vector<std::string> symbols(argv + 2, argv + argc);
+            if (symbols.empty()) symbols = { "AAPL", "MSFT", "SPY" };
+            return run_market_data_live(std::move(symbols));
+        }
+        if (mode == "quotes") return run_quote_cache_benchmark(4'000'000, 3);
+        if (mode == "risk") return run_risk_benchmark(20'000'000);
+        if (mode == "oms") return run_oms_benchmark(5'000'000);
+        if (mode == "rest-sched") return run_rest_scheduler_benchmark();
+        if (mode == "backtest") return run_backtest_benchmark(1'000'000, (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : 0);
+        if (mode == "e2e" || mode == "t2t" || mode == "mock-server") {
+            MockAlpacaServer::Config mock;
+            if (argc > 3) mock.latency = std::chrono::microseconds(std::stoll(argv[3]));
+            if (argc > 4) mock.jitter = std::chrono::microseconds(std::stoll(argv[4]));
+            if (mode == "mock-server") {
+                return run_mock_server(static_cast<unsigned short>((argc > 2) ? std::stoul(argv[2]) : 8443), mock);
+            }
+            const std::uint64_t orders = (argc > 2) ? std::stoull(argv[2]) : 20'000;
+            if (mode == "t2t") return run_tick_to_trade_benchmark(orders, 4, mock);
+            return run_e2e_benchmark(orders, 4, mock);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "fatal: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cerr << "unknown mode: " << mode << "\n";
+    return 2;
+}